@@ -0,0 +1,141 @@
+/**
+ * @file parse_benchmark.cpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Parsing throughput benchmark.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "garcide/groups/artin.h"
+#include "garcide/groups/band.h"
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+using namespace garcide;
+
+using Clock = std::chrono::steady_clock;
+
+// Random words in the atoms, in the syntax `print` uses, with a few powers,
+// separators and deltas thrown in.
+std::string artin_word(sint16 n, sint32 length, std::mt19937_64 &rng) {
+    std::string str;
+    for (sint32 k = 0; k < length; k++) {
+        sint16 i = rng() % (n - 1) + 1;
+        str += (k % 1000 == 999) ? "D" : std::to_string(i);
+        if (k % 7 == 0) {
+            str += " ^ " + std::to_string(sint16(rng() % 5) - 2);
+        }
+        str += (k % 3 == 0) ? " . " : " ";
+    }
+    return str;
+}
+
+std::string band_word(sint16 n, sint32 length, std::mt19937_64 &rng) {
+    std::string str;
+    for (sint32 k = 0; k < length; k++) {
+        sint16 i = rng() % n + 1, j = rng() % (n - 1) + 1;
+        j = j >= i ? j + 1 : j;
+        str += "(" + std::to_string(i) + (k % 2 == 0 ? ", " : " ") +
+               std::to_string(j) + ")";
+        if (k % 7 == 0) {
+            str += "^" + std::to_string(sint16(rng() % 5) - 2);
+        }
+        str += " ";
+    }
+    return str;
+}
+
+// Only reads factors and exponents, as `BraidTemplate::of_string` does, but
+// skips the multiplications, so that this measures the lexer alone.
+template <class U>
+double lex(const std::string &str, typename U::Parameter p,
+           sint32 &number_of_factors) {
+    auto start = Clock::now();
+    U u(p);
+    size_t pos = 0;
+    number_of_factors = 0;
+    while (pos < str.length()) {
+        if (is_whitespace(str[pos]) || str[pos] == '.') {
+            pos++;
+            continue;
+        }
+        u.of_string(str, pos);
+        number_of_factors++;
+        size_t end = pos;
+        StringSpan span;
+        skip_whitespaces(str, end);
+        if (match_char(str, end, '^')) {
+            skip_whitespaces(str, end);
+            if (match_integer(str, end, span)) {
+                integer_of_string(str, span, "Exponent");
+                pos = end;
+            }
+        }
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template <class B>
+double parse(const std::string &str, typename B::Parameter p) {
+    auto start = Clock::now();
+    B b(p);
+    b.of_string(str);
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const char *what, const std::string &str, sint32 factors,
+            double seconds) {
+    ind_cout << what << ": " << sint32(str.length()) << " bytes, " << factors
+             << " factors in " << seconds * 1000 << " ms ("
+             << str.length() / seconds / 1e6 << " MB/s, "
+             << factors / seconds / 1e6 << " M factors/s)" << EndLine();
+}
+
+// Usage: `parse_benchmark.exe [number_of_strands [length [parse_length]]]`.
+// Full parsing is measured on shorter words (`parse_length` factors), as
+// normalizing a random word takes time quadratic in its length.
+int main(int argc, char *argv[]) {
+    sint16 n = argc > 1 ? std::atoi(argv[1]) : 16;
+    sint32 length = argc > 2 ? std::atol(argv[2]) : 100000,
+           parse_length = argc > 3 ? std::atol(argv[3]) : 2000;
+    std::mt19937_64 rng(0);
+    sint32 factors;
+
+    std::string str = artin_word(n, length, rng);
+    double seconds = lex<artin::Underlying>(str, n, factors);
+    report("Artin, lexing only", str, factors, seconds);
+    str = artin_word(n, parse_length, rng);
+    seconds = lex<artin::Underlying>(str, n, factors);
+    report("Artin, parsing", str, factors, parse<artin::Braid>(str, n));
+
+    str = band_word(n, length, rng);
+    seconds = lex<band::Underlying>(str, n, factors);
+    report("Band, lexing only", str, factors, seconds);
+    str = band_word(n, parse_length, rng);
+    seconds = lex<band::Underlying>(str, n, factors);
+    report("Band, parsing", str, factors, parse<band::Braid>(str, n));
+
+    return 0;
+}
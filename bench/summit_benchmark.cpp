@@ -0,0 +1,84 @@
+/**
+ * @file summit_benchmark.cpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Summit set construction benchmark.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "garcide/groups/artin.h"
+#include "garcide/sliding_circuits.h"
+#include "garcide/super_summit.h"
+#include "garcide/ultra_summit.h"
+#include <chrono>
+#include <cstdlib>
+
+using namespace garcide;
+
+using Clock = std::chrono::steady_clock;
+
+// Builds a summit set of each braid with `build`, and reports the total time
+// and number of elements.
+template <class Build>
+void run(const char *what, const std::vector<artin::Braid> &braids,
+         Build build) {
+    auto start = Clock::now();
+    sint32 elements = 0;
+    for (const artin::Braid &b : braids) {
+        elements += build(b);
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    ind_cout << what << ": " << sint32(braids.size()) << " braids, "
+             << elements << " elements in " << seconds * 1000 << " ms ("
+             << elements / seconds << " elements/s)" << EndLine();
+}
+
+// Usage: `summit_benchmark.exe [number_of_strands [length [number]]]`.
+// Summit sets are computed for `number` random braids of canonical length at
+// most `length`.
+int main(int argc, char *argv[]) {
+    sint16 n = argc > 1 ? std::atoi(argv[1]) : 6,
+           length = argc > 2 ? std::atoi(argv[2]) : 4,
+           number = argc > 3 ? std::atoi(argv[3]) : 20;
+
+    std::srand(0);
+    std::vector<artin::Braid> braids;
+    for (sint16 i = 0; i < number; i++) {
+        braids.emplace_back(n);
+        braids.back().randomize(length);
+        braids.back().normalize();
+    }
+
+    run("Super summit sets", braids, [](const artin::Braid &b) {
+        return super_summit::super_summit_set(b).card();
+    });
+    run("Ultra summit sets", braids, [](const artin::Braid &b) {
+        return sint32(ultra_summit::ultra_summit_set(b).card());
+    });
+    run("Sliding circuits sets", braids, [](const artin::Braid &b) {
+        return sint32(sliding_circuits::sliding_circuits_set(b).card());
+    });
+
+    return 0;
+}
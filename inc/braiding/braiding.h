@@ -57,6 +57,60 @@ struct HelpAskedFor {};
  */
 struct InterruptAskedFor {};
 
+#if BRAIDING_CLASS == 0 && defined(BRAIDING_FIXED_STRANDS)
+
+/**
+ * @brief Dispatches on a list of numbers of strands.
+ *
+ * `FixedStrands<N...>::apply(fun, bs...)` calls `fun` on the conversions of
+ * braids `bs` to `garcide::artin::FixedBraid<N>`, for the `N` that is their
+ * number of strands, or on `bs` themselves if there is no such `N`.
+ *
+ * @tparam N Numbers of strands for which fixed-size factors are used.
+ */
+template <sint16... N> struct FixedStrands;
+
+template <> struct FixedStrands<> {
+    template <class Fun, class... Braids>
+    static void apply(Fun fun, const Braids &...bs) {
+        fun(bs...);
+    }
+};
+
+template <sint16 N, sint16... Ns> struct FixedStrands<N, Ns...> {
+    template <class Fun, class... Braids>
+    static void apply(Fun fun, const Braid &b, const Braids &...bs) {
+        if (b.get_parameter() == N) {
+            fun(garcide::artin::to_fixed<N>(b),
+                garcide::artin::to_fixed<N>(bs)...);
+        } else {
+            FixedStrands<Ns...>::apply(fun, b, bs...);
+        }
+    }
+};
+
+#endif
+
+/**
+ * @brief Runs a computation on braids.
+ *
+ * Calls `fun` on `bs`, which must share the same parameter. If _Braiding_ was
+ * built with fixed-size factors for that parameter (see
+ * `FIXED_STRANDS_FOR_BRAIDING`), the braids are converted first, so `fun`
+ * should be generic.
+ *
+ * @param fun The computation.
+ * @param bs The braids.
+ */
+template <class Fun, class... Braids>
+void dispatch(Fun fun, const Braids &...bs) {
+#if BRAIDING_CLASS == 0 && defined(BRAIDING_FIXED_STRANDS)
+    FixedStrands<BRAIDING_FIXED_STRANDS>::apply(fun, bs...);
+#else
+    fun(bs...);
+#endif
+}
+
 enum class Option {
     LCF,
     RCF,
@@ -76,6 +130,19 @@ enum class Option {
 #endif
 };
 
+/**
+ * @brief Matches a command.
+ *
+ * Tells whether `str` is `command`, up to surrounding whitespaces. Upper case
+ * letters in `command` match either case, other characters only match
+ * themselves.
+ *
+ * @param str The string to match (usually a line of input).
+ * @param command The command.
+ * @return Whether `str` matches `command`.
+ */
+bool is_command(const std::string &str, const char *command);
+
 /**
  * @brief Reads a line from `is` as a braid.
  *
@@ -0,0 +1,325 @@
+/**
+ * @file braid_store.hpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header (and implementation) file for arena-backed braid storage.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BRAID_STORE
+#define BRAID_STORE
+
+#include "garcide/garcide.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace garcide {
+
+/**
+ * @brief An append-only sequence of braids, whose factors live in an arena.
+ *
+ * Summit sets hold many braids that are never modified once inserted.
+ * Storing them as `BraidTemplate`s costs a heap block per braid (plus the
+ * braid itself). A `BraidStore` instead copies the canonical factors of each
+ * braid it is given into large blocks, each braid's factors being
+ * contiguous, and only keeps a small record (factors, infimum, canonical
+ * length and hash) per braid. Destroying a store frees its blocks in one go.
+ *
+ * Braids are identified by their index, in insertion order. Accessing a
+ * braid by index rebuilds a `BraidTemplate`, but comparing and hashing
+ * stored braids is done in place.
+ *
+ * Blocks never move, and nothing is modified by const methods: those may
+ * run concurrently, as long as no braid is being inserted.
+ *
+ * @tparam F The factor class.
+ */
+template <class F> class BraidStore {
+
+  public:
+    using Braid = BraidTemplate<F>;
+
+  private:
+    /**
+     * @brief Minimum number of factors in a block.
+     */
+    static constexpr std::size_t BLOCK_SIZE = 4096;
+
+    struct Record {
+        const F *factors;
+
+        std::size_t hash;
+
+        std::int32_t inf;
+
+        std::uint32_t canonical_length;
+    };
+
+    struct Block {
+        F *factors;
+
+        std::size_t capacity;
+
+        // Number of factors in the block.
+        std::size_t size;
+    };
+
+    std::vector<Record> records;
+
+    std::vector<Block> blocks;
+
+    // Parameter of the stored braids. Only meaningful when there is one.
+    std::unique_ptr<typename F::Parameter> parameter;
+
+    // The block to put `n` more factors in.
+    Block &reserve(std::size_t n) {
+        if (blocks.empty() || blocks.back().size + n > blocks.back().capacity) {
+            std::size_t capacity = std::max(n, BLOCK_SIZE);
+            blocks.push_back(
+                Block{std::allocator<F>().allocate(capacity), capacity, 0});
+        }
+        return blocks.back();
+    }
+
+    // Destructors are only called if they do something.
+    void release() {
+        std::allocator<F> allocator;
+        for (Block &block : blocks) {
+            if (!std::is_trivially_destructible<F>::value) {
+                for (std::size_t j = 0; j < block.size; j++) {
+                    block.factors[j].~F();
+                }
+            }
+            allocator.deallocate(block.factors, block.capacity);
+        }
+        blocks.clear();
+        records.clear();
+    }
+
+  public:
+    /**
+     * @brief Const iterator on the braids of a `BraidStore`.
+     *
+     * Dereferencing builds the braid, which is returned by value.
+     */
+    class ConstIterator {
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = Braid;
+        using pointer = void;
+        using reference = Braid;
+
+      private:
+        const BraidStore *store;
+
+        std::size_t index;
+
+      public:
+        ConstIterator(const BraidStore &store, std::size_t index)
+            : store(&store), index(index) {}
+
+        reference operator*() const { return store->at(index); }
+
+        // Prefix increment
+        ConstIterator &operator++() {
+            index++;
+            return *this;
+        }
+
+        // Postfix increment
+        ConstIterator operator++(int) {
+            ConstIterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const ConstIterator &b) const {
+            return index == b.index;
+        }
+        bool operator!=(const ConstIterator &b) const {
+            return index != b.index;
+        }
+    };
+
+    BraidStore() : records(), blocks(), parameter() {}
+
+    BraidStore(const BraidStore &s) : BraidStore() {
+        for (std::size_t i = 0; i < s.size(); i++) {
+            push_back(s.at(i));
+        }
+    }
+
+    BraidStore(BraidStore &&s) noexcept
+        : records(std::move(s.records)), blocks(std::move(s.blocks)),
+          parameter(std::move(s.parameter)) {
+        s.records.clear();
+        s.blocks.clear();
+    }
+
+    BraidStore &operator=(const BraidStore &s) {
+        if (this != &s) {
+            BraidStore t(s);
+            *this = std::move(t);
+        }
+        return *this;
+    }
+
+    BraidStore &operator=(BraidStore &&s) noexcept {
+        if (this != &s) {
+            release();
+            records = std::move(s.records);
+            blocks = std::move(s.blocks);
+            parameter = std::move(s.parameter);
+            s.records.clear();
+            s.blocks.clear();
+        }
+        return *this;
+    }
+
+    ~BraidStore() { release(); }
+
+    inline ConstIterator begin() const { return ConstIterator(*this, 0); }
+
+    inline ConstIterator end() const { return ConstIterator(*this, size()); }
+
+    inline std::size_t size() const { return records.size(); }
+
+    /**
+     * @brief Appends a braid.
+     *
+     * Its factors are copied in the last block (or in a new one, if they do
+     * not fit).
+     *
+     * @param b The braid to append. Its parameter must be the same as that
+     * of braids already in the store.
+     * @return Its index.
+     */
+    std::size_t push_back(const Braid &b) {
+        if (!parameter) {
+            parameter.reset(new typename F::Parameter(b.get_parameter()));
+        }
+        std::size_t length = b.canonical_length();
+        Block &block = reserve(length);
+        const F *factors = block.factors + block.size;
+        for (typename Braid::ConstFactorItr it = b.cbegin(); it != b.cend();
+             it++) {
+            ::new (static_cast<void *>(block.factors + block.size)) F(*it);
+            block.size++;
+        }
+        records.push_back(
+            Record{factors, std::hash<Braid>()(b), std::int32_t(b.inf()),
+                   std::uint32_t(length)});
+        return records.size() - 1;
+    }
+
+    /**
+     * @brief Rebuilds a braid.
+     *
+     * @param i An index.
+     * @return The braid with index `i`.
+     */
+    Braid at(std::size_t i) const {
+        const Record &r = records[i];
+        Braid b(*parameter);
+        b.assign_lcf(r.inf, r.factors, r.factors + r.canonical_length);
+        return b;
+    }
+
+    /**
+     * @brief First factor of a braid.
+     *
+     * @param i The index of a braid with positive canonical length.
+     * @return Its first factor.
+     */
+    inline const F &first(std::size_t i) const { return records[i].factors[0]; }
+
+    /**
+     * @brief Hash of a braid.
+     *
+     * @param i An index.
+     * @return `std::hash` of the braid with index `i`.
+     */
+    inline std::size_t hash(std::size_t i) const { return records[i].hash; }
+
+    /**
+     * @brief Compares a stored braid to another one.
+     *
+     * @param i An index.
+     * @param b A braid.
+     * @return Whether the braid with index `i` is `b`.
+     */
+    bool equals(std::size_t i, const Braid &b) const {
+        const Record &r = records[i];
+        if (r.inf != b.inf() || r.canonical_length != b.canonical_length()) {
+            return false;
+        }
+        const F *f = r.factors;
+        for (typename Braid::ConstFactorItr it = b.cbegin(); it != b.cend();
+             it++, f++) {
+            if (*f != *it) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Compares two stored braids, in the order of
+     * `BraidTemplate::order`.
+     *
+     * @param i An index.
+     * @param j An index.
+     * @return A negative, zero or positive integer, depending on whether the
+     * braid with index `i` comes before, is equal to, or comes after the
+     * braid with index `j`.
+     */
+    int order(std::size_t i, std::size_t j) const {
+        const Record &r = records[i], &s = records[j];
+        if (r.inf != s.inf) {
+            return r.inf < s.inf ? -1 : 1;
+        }
+        if (r.canonical_length != s.canonical_length) {
+            return r.canonical_length < s.canonical_length ? -1 : 1;
+        }
+        for (std::uint32_t k = 0; k < r.canonical_length; k++) {
+            int o = r.factors[k].order(s.factors[k]);
+            if (o != 0) {
+                return o;
+            }
+        }
+        return 0;
+    }
+};
+
+} // namespace garcide
+
+#endif
@@ -212,24 +212,20 @@ centralizer(const ultra_summit::UltraSummitSet<BraidTemplate<F>> &uss,
 
     for (size_t orbit_index = 0; orbit_index < uss.number_of_orbits();
          orbit_index++) {
+        // The orbit's cycling data is shared by the orbit generator and the
+        // transports.
+        ultra_summit::CyclingCache<F> cache(uss.at(orbit_index, (size_t)0));
+
         BraidTemplate<F> d = ultra_summit::tree_path(
                              uss.at(orbit_index, (size_t)0), uss, mins, prev),
-                         c = d, b2(b.get_parameter());
-        for (size_t shift = 0; shift < uss.orbit_size(orbit_index); shift++) {
-            c.right_multiply(
-                uss.at(orbit_index, shift).first().delta_conjugate(b.inf()));
-        }
-        c.right_multiply(!d);
+                         c = d * cache.orbit_product() * !d,
+                         b2(b.get_parameter());
 
         if (!(c.is_identity())) {
             centralizer.insert(c);
         }
 
-        BraidTemplate<F> orbit_base_rcf = uss.at(orbit_index, (size_t)0);
-        orbit_base_rcf.lcf_to_rcf();
-
-        std::vector<F> min = ultra_summit::min_ultra_summit(
-            uss.at(orbit_index, (size_t)0), orbit_base_rcf);
+        std::vector<F> min = ultra_summit::min_ultra_summit(cache);
 
         for (typename std::vector<F>::const_iterator it = min.begin();
              it != min.end(); it++) {
@@ -247,14 +243,14 @@ centralizer(const ultra_summit::UltraSummitSet<BraidTemplate<F>> &uss,
 }
 
 /**
- * @brief Computes `b`'s centralizer.
+ * @brief Computes `b`'s centralizer, without looking at the class cache.
  * 
  * @tparam F A class representing factors.
  * @param b The braid whose centralizer is to be computed.
  * @return `b`'s centralizer.
  */
 template <class F>
-Centralizer<BraidTemplate<F>> centralizer(const BraidTemplate<F> &b) {
+Centralizer<BraidTemplate<F>> uncached_centralizer(const BraidTemplate<F> &b) {
     std::vector<F> mins;
     std::vector<sint16> prev;
 
@@ -279,6 +275,55 @@ Centralizer<BraidTemplate<F>> centralizer(const BraidTemplate<F> &b) {
     return centralizer;
 }
 
+/**
+ * @brief Computes `b`'s centralizer.
+ *
+ * If the class cache is enabled (see `enable_class_cache`), generators of
+ * the centralizer of the canonical representative of `b` are looked up
+ * there first (and stored there otherwise), and then conjugated back to
+ * `b`.
+ *
+ * @tparam F A class representing factors.
+ * @param b The braid whose centralizer is to be computed.
+ * @return `b`'s centralizer.
+ */
+template <class F>
+Centralizer<BraidTemplate<F>> centralizer(const BraidTemplate<F> &b) {
+    ClassCache *cache = class_cache();
+    if (cache == nullptr) {
+        return uncached_centralizer(b);
+    }
+
+    BraidTemplate<F> c(b.get_parameter());
+    BraidTemplate<F> representative =
+        sliding_circuits::canonical_representative(b, c);
+    std::string key = class_key('C', representative), bytes;
+    if (!cache->find(key, bytes)) {
+        Centralizer<BraidTemplate<F>> centralizer_representative =
+            uncached_centralizer(representative);
+        append_varint(bytes, centralizer_representative.number_of_generators());
+        for (typename Centralizer<BraidTemplate<F>>::ConstIterator it =
+                 centralizer_representative.begin();
+             it != centralizer_representative.end(); it++) {
+            (*it).to_bytes(bytes);
+        }
+        cache->insert(key, bytes);
+    }
+
+    Centralizer<BraidTemplate<F>> centralizer;
+    BraidTemplate<F> d(b.get_parameter());
+    c = !c;
+    size_t pos = 0;
+    for (uint64 number_of_generators = read_varint(bytes, pos), i = 0;
+         i < number_of_generators; i++) {
+        d.of_bytes(bytes, pos);
+        d.conjugate(c);
+        centralizer.insert(d);
+    }
+
+    return centralizer;
+}
+
 } // namespace garcide::centralizer
 
 #endif
\ No newline at end of file
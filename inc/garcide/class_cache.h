@@ -0,0 +1,186 @@
+/**
+ * @file class_cache.h
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header file for the persistent conjugacy class cache.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLASS_CACHE
+#define CLASS_CACHE
+
+#include "garcide/garcide.h"
+#include <cstddef>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+
+namespace garcide {
+
+/**
+ * @brief A file-backed store of computed conjugacy class data.
+ *
+ * Summit sets, centralizers and Thurston types only depend on the
+ * conjugacy class (up to a known conjugator), and the same classes tend to
+ * come up again from one run to the next. A `ClassCache` keeps what was
+ * computed for them in a file, as a log of (key, value) records in the
+ * format of `RecordWriter`, keys being built by `class_key`.
+ *
+ * The file is memory-mapped when the cache is opened, and indexed. Values
+ * inserted afterwards are appended to it, and kept in memory until the
+ * cache is closed. Methods lock the cache, and may thus be called
+ * concurrently. The file should not be opened by several processes at once.
+ */
+class ClassCache {
+
+  private:
+    std::string path;
+
+    // The file's contents, as they were when it was opened.
+    const char *mapped;
+
+    std::size_t mapped_size;
+
+    // Key to position and length of the value, in `mapped`.
+    std::unordered_map<std::string_view, std::pair<std::size_t, std::size_t>>
+        index;
+
+    // Values inserted since the file was opened.
+    std::unordered_map<std::string, std::string> added;
+
+    mutable std::mutex mutex;
+
+  public:
+    /**
+     * @brief Opens (or creates) a cache file.
+     *
+     * A truncated last record, left by an interrupted write, is dropped.
+     *
+     * @param path The file's path.
+     * @exception std::runtime_error Thrown when the file cannot be read or
+     * mapped.
+     */
+    explicit ClassCache(const std::string &path);
+
+    ClassCache(const ClassCache &) = delete;
+
+    ClassCache &operator=(const ClassCache &) = delete;
+
+    ~ClassCache();
+
+    /**
+     * @brief Looks a key up.
+     *
+     * @param key A key.
+     * @param value Set to the value of `key`, if there is one.
+     * @return Whether there is one.
+     */
+    bool find(const std::string &key, std::string &value) const;
+
+    /**
+     * @brief Inserts a value, and appends it to the file.
+     *
+     * Nothing is done if `key` already has a value.
+     *
+     * @param key A key.
+     * @param value Its value.
+     * @exception std::runtime_error Thrown when writing failed.
+     */
+    void insert(const std::string &key, const std::string &value);
+
+    /**
+     * @brief Number of keys.
+     *
+     * @return std::size_t
+     */
+    std::size_t size() const;
+};
+
+/**
+ * @brief Enables the class cache.
+ *
+ * Once enabled, `ultra_summit::ultra_summit_set`, `centralizer::centralizer`
+ * and `artin::thurston_type` look their result up in the cache first, and
+ * store it there when they have to compute it. Looking a braid up takes
+ * computing its canonical representative (see
+ * `sliding_circuits::canonical_representative`), and thus its whole sliding
+ * circuits set. `artin::thurston_type` therefore only does so once it failed
+ * to find a reducing element among the first few elements of the USS.
+ *
+ * Neither this nor `disable_class_cache` may be called while the cache is
+ * in use.
+ *
+ * @param path The cache file's path.
+ * @exception std::runtime_error Thrown when it cannot be opened.
+ */
+void enable_class_cache(const std::string &path);
+
+/**
+ * @brief Disables the class cache, and closes its file.
+ */
+void disable_class_cache();
+
+/**
+ * @brief The class cache.
+ *
+ * @return A pointer to it if it is enabled, `nullptr` otherwise.
+ */
+ClassCache *class_cache();
+
+/**
+ * @brief Key of some data about a conjugacy class, in a `ClassCache`.
+ *
+ * It is made of a tag for the kind of data, of the factor class's name and
+ * the parameter (so that groups do not mix), and of the binary encoding of
+ * the class's canonical representative.
+ *
+ * @tparam F The factor class.
+ * @param kind A character that tells what kind of data the key is for.
+ * @param representative The canonical representative of the class.
+ * @return The key.
+ */
+template <class F>
+std::string class_key(char kind, const BraidTemplate<F> &representative) {
+    std::ostringstream parameter;
+    IndentedOStream os(parameter);
+    os << representative.get_parameter();
+
+    std::string key(1, kind);
+    std::string name = typeid(F).name();
+    append_varint(key, name.size());
+    key += name;
+    std::string p = parameter.str();
+    append_varint(key, p.size());
+    key += p;
+    representative.to_bytes(key);
+    return key;
+}
+
+} // namespace garcide
+
+#endif
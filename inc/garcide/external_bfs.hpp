@@ -0,0 +1,568 @@
+/**
+ * @file external_bfs.hpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header (and implementation) file for breadth-first searches that
+ * spill to disk.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EXTERNAL_BFS
+#define EXTERNAL_BFS
+
+#include "garcide/utility.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace garcide {
+
+/**
+ * @brief Settings for searches that spill to disk.
+ */
+struct SpillOptions {
+    /**
+     * @brief Directory in which temporary files are created.
+     *
+     * If empty, the system's temporary directory is used.
+     */
+    std::string directory;
+
+    /**
+     * @brief Number of bytes of records to hold in memory before spilling
+     * them to disk.
+     *
+     * Elements of a level are expanded by chunks of about a quarter of it,
+     * and the records they produce are written to disk as a sorted run
+     * whenever they take more than it. Memory use is thus about twice that,
+     * plus the cost of expanding one element.
+     */
+    std::size_t memory_budget;
+
+    SpillOptions() : directory(), memory_budget(std::size_t(64) << 20) {}
+
+    SpillOptions(const std::string &directory, std::size_t memory_budget)
+        : directory(directory), memory_budget(memory_budget) {}
+};
+
+/**
+ * @brief A record of a spill file.
+ *
+ * Records are identified by their key. The payload holds whatever else is
+ * needed to rebuild the element (e.g. its parent in the search tree).
+ */
+struct SpillRecord {
+    std::string key;
+
+    std::string payload;
+
+    bool operator<(const SpillRecord &r) const {
+        return std::tie(key, payload) < std::tie(r.key, r.payload);
+    }
+
+    // Approximate number of bytes it takes in memory.
+    inline std::size_t footprint() const {
+        return sizeof(SpillRecord) + key.size() + payload.size();
+    }
+};
+
+/**
+ * @brief Appends an index to a byte string, on 8 bytes, most significant
+ * first.
+ *
+ * Payloads starting with an index thus compare like the indexes do.
+ *
+ * @param bytes The byte string to append to.
+ * @param x The index to append.
+ */
+inline void append_index(std::string &bytes, uint64 x) {
+    for (sint16 i = 7; i >= 0; i--) {
+        bytes.push_back(char((x >> (8 * i)) & 0xFF));
+    }
+}
+
+/**
+ * @brief Reads an index written by `append_index`.
+ *
+ * @param bytes The byte string to read from.
+ * @param pos The position to start from. It is set past the index.
+ * @return The index.
+ * @exception InvalidStringError Thrown when `bytes` ends before the index
+ * does.
+ */
+inline uint64 read_index(const std::string &bytes, size_t &pos) {
+    if (pos + 8 > bytes.size()) {
+        throw InvalidStringError("Truncated index!");
+    }
+    uint64 x = 0;
+    for (sint16 i = 0; i < 8; i++) {
+        x = (x << 8) | uint64(uint8(bytes[pos++]));
+    }
+    return x;
+}
+
+/**
+ * @brief Writes records to a file.
+ *
+ * Each record is written as the varint length of its key, its key, the
+ * varint length of its payload and its payload.
+ */
+class RecordWriter {
+
+  private:
+    std::ofstream out;
+
+    std::string buffer;
+
+  public:
+    /**
+     * @brief Opens a file for writing.
+     *
+     * @param path The file's path.
+     * @param append Whether records are appended to the file, rather than
+     * replacing its contents.
+     * @exception std::runtime_error Thrown when the file cannot be opened.
+     */
+    explicit RecordWriter(const std::string &path, bool append = false)
+        : out(path, std::ios::binary |
+                        (append ? std::ios::app : std::ios::trunc)),
+          buffer() {
+        if (!out) {
+            throw std::runtime_error("Could not open " + path + "!");
+        }
+    }
+
+    void write(const std::string &key, const std::string &payload) {
+        buffer.clear();
+        append_varint(buffer, key.size());
+        buffer += key;
+        append_varint(buffer, payload.size());
+        buffer += payload;
+        out.write(buffer.data(), buffer.size());
+    }
+
+    inline void write(const SpillRecord &r) { write(r.key, r.payload); }
+
+    /**
+     * @brief Flushes and closes the file.
+     *
+     * @exception std::runtime_error Thrown when writing failed.
+     */
+    void close() {
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Could not write spill file!");
+        }
+    }
+};
+
+/**
+ * @brief Reads records written by a `RecordWriter`.
+ */
+class RecordReader {
+
+  private:
+    std::ifstream in;
+
+    // Reads a varint. Returns `false` if the file ends before it starts.
+    bool read_varint(uint64 &x) {
+        x = 0;
+        for (sint16 shift = 0; shift < 64; shift += 7) {
+            int c = in.get();
+            if (c == std::ifstream::traits_type::eof()) {
+                if (shift == 0) {
+                    return false;
+                }
+                throw InvalidStringError("Truncated spill file!");
+            }
+            x |= uint64(c & 0x7F) << shift;
+            if ((c & 0x80) == 0) {
+                return true;
+            }
+        }
+        throw InvalidStringError("Varint is too long!");
+    }
+
+    void read_string(std::string &str) {
+        uint64 length;
+        if (!read_varint(length)) {
+            throw InvalidStringError("Truncated spill file!");
+        }
+        str.resize(length);
+        if (!in.read(str.data(), length)) {
+            throw InvalidStringError("Truncated spill file!");
+        }
+    }
+
+  public:
+    /**
+     * @brief Opens a file for reading.
+     *
+     * @param path The file's path.
+     * @param offset Number of bytes to skip. It should be the position of a
+     * record.
+     * @exception std::runtime_error Thrown when the file cannot be opened.
+     */
+    explicit RecordReader(const std::string &path, uint64 offset = 0)
+        : in(path, std::ios::binary) {
+        if (!in) {
+            throw std::runtime_error("Could not open " + path + "!");
+        }
+        in.seekg(offset);
+    }
+
+    /**
+     * @brief Reads the next record.
+     *
+     * @param r Set to the record.
+     * @return Whether there was one (`false` at the end of the file).
+     * @exception InvalidStringError Thrown when the file ends in the middle
+     * of a record.
+     */
+    bool next(SpillRecord &r) {
+        uint64 length;
+        if (!read_varint(length)) {
+            return false;
+        }
+        r.key.resize(length);
+        if (!in.read(r.key.data(), length)) {
+            throw InvalidStringError("Truncated spill file!");
+        }
+        read_string(r.payload);
+        return true;
+    }
+};
+
+/**
+ * @brief Merges sorted runs of records.
+ *
+ * Records are read from all runs at once, and returned in increasing order
+ * (of keys, then of payloads).
+ */
+class RunMerger {
+
+  private:
+    std::vector<std::unique_ptr<RecordReader>> readers;
+
+    // The next record of each run.
+    std::vector<SpillRecord> heads;
+
+    struct Greater {
+        const std::vector<SpillRecord> *heads;
+
+        bool operator()(std::size_t i, std::size_t j) const {
+            return (*heads)[j] < (*heads)[i];
+        }
+    };
+
+    std::priority_queue<std::size_t, std::vector<std::size_t>, Greater> queue;
+
+  public:
+    explicit RunMerger(const std::vector<std::string> &runs)
+        : readers(), heads(runs.size()), queue(Greater{&heads}) {
+        for (std::size_t i = 0; i < runs.size(); i++) {
+            readers.emplace_back(new RecordReader(runs[i]));
+            if (readers[i]->next(heads[i])) {
+                queue.push(i);
+            }
+        }
+    }
+
+    /**
+     * @brief Reads the smallest record left.
+     *
+     * @param r Set to the record.
+     * @return Whether there was one.
+     */
+    bool next(SpillRecord &r) {
+        if (queue.empty()) {
+            return false;
+        }
+        std::size_t i = queue.top();
+        queue.pop();
+        std::swap(r, heads[i]);
+        if (readers[i]->next(heads[i])) {
+            queue.push(i);
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief A temporary directory, that is removed (with its contents) when it
+ * is destroyed.
+ */
+class SpillDirectory {
+
+  private:
+    std::filesystem::path path;
+
+    std::size_t files;
+
+  public:
+    /**
+     * @brief Creates a fresh directory.
+     *
+     * @param parent The directory to create it in (or the system's temporary
+     * directory, if empty).
+     */
+    explicit SpillDirectory(const std::string &parent) : path(), files(0) {
+        std::filesystem::path base =
+            parent.empty() ? std::filesystem::temp_directory_path()
+                           : std::filesystem::path(parent);
+        std::random_device device;
+        std::mt19937_64 generator(device());
+        do {
+            path = base / ("garcide-" + std::to_string(generator()));
+        } while (!std::filesystem::create_directory(path));
+    }
+
+    SpillDirectory(const SpillDirectory &) = delete;
+
+    SpillDirectory &operator=(const SpillDirectory &) = delete;
+
+    ~SpillDirectory() {
+        std::error_code error;
+        std::filesystem::remove_all(path, error);
+    }
+
+    // A fresh file name in the directory.
+    std::string file() {
+        return (path / ("run-" + std::to_string(files++))).string();
+    }
+};
+
+/**
+ * @brief Breadth-first search, with delayed duplicate detection on disk.
+ *
+ * Elements are identified by records, whose keys must be unique to each
+ * element. Elements are written to the file at `path` as they are found,
+ * level by level, and numbered in that order, starting with `root` (which is
+ * numbered `0`). The search does not hold the set in memory:
+ *
+ * - the elements of a level are read back from `path` by chunks, and
+ * expanded (concurrently, with `USE_PAR`);
+ * - the records they produce are buffered, and written to disk as runs,
+ * sorted by key, whenever they take more than `options.memory_budget` bytes;
+ * - those runs are then merged, and their keys are checked against runs of
+ * the keys of already found elements (which are sorted too), so that
+ * duplicates are detected by a linear scan rather than by random accesses;
+ * - the new elements are appended to `path` (in increasing order of keys),
+ * and their keys make a new run of found keys.
+ *
+ * Runs of found keys are merged whenever there are too many of them. When an
+ * element is found several times in the same level, the record with the
+ * smallest payload is kept.
+ *
+ * @tparam Expand A class of functions of signature
+ * `void _(const SpillRecord &r, std::size_t i, std::vector<SpillRecord> &out)`
+ * that append to `out` the records of the neighbours of the element with
+ * record `r` and number `i`. They may be called concurrently.
+ * @param root The first element.
+ * @param expand The function that computes neighbours.
+ * @param path Path of the file the elements are written to. It is
+ * overwritten.
+ * @param options Where temporary files go, and how much memory to use.
+ * @return The number of elements.
+ */
+template <class Expand>
+std::size_t external_bfs(const SpillRecord &root, Expand expand,
+                         const std::string &path,
+                         const SpillOptions &options) {
+    // Runs of found keys are merged when there are more than that.
+    const std::size_t MAX_RUNS = 8;
+
+    // An element of the current level, and what it expanded to.
+    struct Element {
+        SpillRecord r;
+        std::size_t index;
+        std::vector<SpillRecord> children;
+    };
+
+    SpillDirectory directory(options.directory);
+    std::size_t budget = std::max(options.memory_budget, std::size_t(1));
+
+    std::vector<std::string> found;
+    {
+        RecordWriter out(path);
+        out.write(root);
+        out.close();
+        found.push_back(directory.file());
+        RecordWriter run(found.back());
+        run.write(root.key, "");
+        run.close();
+    }
+
+    std::size_t count = 1, level_size = 1;
+    uint64 level_begin = 0;
+
+    while (level_size != 0) {
+        std::vector<std::string> runs;
+        std::vector<SpillRecord> buffer;
+        std::size_t buffer_bytes = 0;
+
+        // Writes the buffer as a sorted run, without duplicate keys.
+        auto spill = [&directory, &runs, &buffer, &buffer_bytes]() {
+            std::sort(buffer.begin(), buffer.end());
+            buffer.erase(std::unique(buffer.begin(), buffer.end(),
+                                     [](const SpillRecord &r,
+                                        const SpillRecord &s) {
+                                         return r.key == s.key;
+                                     }),
+                         buffer.end());
+            runs.push_back(directory.file());
+            RecordWriter run(runs.back());
+            for (const SpillRecord &r : buffer) {
+                run.write(r);
+            }
+            run.close();
+            buffer.clear();
+            buffer_bytes = 0;
+        };
+
+        std::vector<Element> chunk;
+        std::size_t chunk_bytes = 0;
+
+        auto expand_element = [&expand](Element &e) {
+            expand(e.r, e.index, e.children);
+        };
+
+        auto expand_chunk = [&]() {
+
+#ifndef USE_PAR
+
+            std::for_each(chunk.begin(), chunk.end(), expand_element);
+
+#else
+
+            std::for_each(std::execution::par, chunk.begin(), chunk.end(),
+                          expand_element);
+
+#endif
+
+            for (Element &e : chunk) {
+                for (SpillRecord &r : e.children) {
+                    buffer_bytes += r.footprint();
+                    buffer.push_back(std::move(r));
+                    if (buffer_bytes >= budget) {
+                        spill();
+                    }
+                }
+            }
+            chunk.clear();
+            chunk_bytes = 0;
+        };
+
+        {
+            RecordReader in(path, level_begin);
+            SpillRecord r;
+            std::size_t index = count - level_size;
+            while (in.next(r)) {
+                chunk_bytes += r.footprint();
+                chunk.push_back(Element{std::move(r), index++, {}});
+                if (chunk_bytes >= budget / 4) {
+                    expand_chunk();
+                }
+            }
+            expand_chunk();
+        }
+        spill();
+
+        level_begin = std::filesystem::file_size(path);
+        level_size = 0;
+
+        {
+            RecordWriter out(path, true);
+            found.push_back(directory.file());
+            RecordWriter run(found.back());
+
+            RunMerger candidates(runs), old(std::vector<std::string>(
+                                            found.begin(), found.end() - 1));
+            SpillRecord r, o;
+            std::string last;
+            bool has_last = false, has_old = old.next(o);
+
+            while (candidates.next(r)) {
+                // Only the smallest record of each key is kept.
+                if (has_last && r.key == last) {
+                    continue;
+                }
+                has_last = true;
+                last = r.key;
+
+                while (has_old && o.key < r.key) {
+                    has_old = old.next(o);
+                }
+                if (has_old && o.key == r.key) {
+                    continue;
+                }
+
+                out.write(r);
+                run.write(r.key, "");
+                level_size++;
+            }
+
+            out.close();
+            run.close();
+        }
+        count += level_size;
+
+        for (const std::string &file : runs) {
+            std::filesystem::remove(file);
+        }
+
+        if (found.size() > MAX_RUNS) {
+            std::string merged = directory.file();
+            {
+                RunMerger all(found);
+                RecordWriter compacted(merged);
+                SpillRecord r;
+                while (all.next(r)) {
+                    compacted.write(r);
+                }
+                compacted.close();
+            }
+            for (const std::string &file : found) {
+                std::filesystem::remove(file);
+            }
+            found.assign(1, merged);
+        }
+    }
+
+    return count;
+}
+
+} // namespace garcide
+
+#endif
@@ -0,0 +1,299 @@
+/**
+ * @file flat_index.hpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header (and implementation) file for hash indexes over stored
+ * braids, and fingerprint sets.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FLAT_INDEX
+#define FLAT_INDEX
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace garcide {
+
+/**
+ * @brief A hash index over the braids of a `BraidStore`.
+ *
+ * Summit sets store their elements once, in a `BraidStore`. A `FlatIndex`
+ * answers membership queries on those elements without holding a copy of
+ * them: it is an open addressing table whose slots are indexes in the store,
+ * along with a few bits of the braid's hash to skip most comparisons. Hashes
+ * are never recomputed, as the store keeps them.
+ *
+ * The store is not kept in the index, but passed to each method. It must be
+ * the same every time, except that braids may be appended to it, and then
+ * inserted with `insert`. Lookups do not modify the index, and may thus run
+ * concurrently.
+ *
+ * @tparam Store The store class, a `BraidStore<F>` for some `F`.
+ */
+template <class Store> class FlatIndex {
+
+  private:
+    using Braid = typename Store::Braid;
+
+    struct Slot {
+        // High bits of the braid's hash.
+        std::uint32_t tag;
+
+        // Index in the store, plus one (`0` stands for an empty slot).
+        std::uint32_t index;
+    };
+
+    std::vector<Slot> slots;
+
+    // Number of occupied slots.
+    std::size_t size;
+
+    static inline std::uint32_t tag(std::size_t h) {
+        return std::uint32_t(std::uint64_t(h) >> 32);
+    }
+
+    // Puts an index in the first free slot after `h`, assuming it is not in
+    // the table yet.
+    void place(std::size_t h, std::size_t index) {
+        std::size_t mask = slots.size() - 1;
+        std::size_t i = h & mask;
+        while (slots[i].index != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = Slot{tag(h), std::uint32_t(index + 1)};
+    }
+
+    // Doubles the number of slots (or allocates the first ones).
+    void grow(const Store &store) {
+        std::vector<Slot> old(slots.size() == 0 ? 16 : 2 * slots.size(),
+                              Slot{0, 0});
+        std::swap(old, slots);
+        for (const Slot &s : old) {
+            if (s.index != 0) {
+                place(store.hash(s.index - 1), s.index - 1);
+            }
+        }
+    }
+
+  public:
+    FlatIndex() : slots(), size(0) {}
+
+    /**
+     * @brief Looks a braid up.
+     *
+     * @param b The braid to look for.
+     * @param store The store the index is over.
+     * @param index Set to the index of `b` in `store`, if it is found.
+     * @return Whether `b` is in the index.
+     */
+    bool find(const Braid &b, const Store &store, std::size_t &index) const {
+        if (size == 0) {
+            return false;
+        }
+        std::size_t h = std::hash<Braid>()(b), mask = slots.size() - 1;
+        std::uint32_t t = tag(h);
+        for (std::size_t i = h & mask; slots[i].index != 0;
+             i = (i + 1) & mask) {
+            const Slot &s = slots[i];
+            if (s.tag == t && store.equals(s.index - 1, b)) {
+                index = s.index - 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Checks membership.
+     *
+     * @param b The braid to look for.
+     * @param store The store the index is over.
+     * @return Whether `b` is in the index.
+     */
+    bool mem(const Braid &b, const Store &store) const {
+        std::size_t index;
+        return find(b, store, index);
+    }
+
+    /**
+     * @brief Indexes a braid of the store.
+     *
+     * It must not be in the index already.
+     *
+     * @param index Its index in `store`.
+     * @param store The store the index is over.
+     */
+    void insert(std::size_t index, const Store &store) {
+        // Load factor is kept below one half.
+        if (2 * (size + 1) > slots.size()) {
+            grow(store);
+        }
+        place(store.hash(index), index);
+        size++;
+    }
+
+    /**
+     * @brief Number of indexed braids.
+     *
+     * @return std::size_t
+     */
+    inline std::size_t card() const { return size; }
+};
+
+/**
+ * @brief A set of 64-bit fingerprints.
+ *
+ * Used to remember which braids were already visited when enumerating a
+ * summit set without storing it: each braid is represented by its hash only.
+ * Two distinct braids with the same hash are thus confused, which with
+ * `hash_mix`-based hashes happens with probability about `N * N / 2^65`
+ * for `N` braids.
+ *
+ * It is an open addressing table, that holds nothing but the fingerprints.
+ * Lookups do not modify it, and may thus run concurrently.
+ */
+class FingerprintSet {
+
+  private:
+    // `0` stands for an empty slot. The fingerprint `0` is stored as `1`.
+    std::vector<std::uint64_t> slots;
+
+    // Number of occupied slots.
+    std::size_t size;
+
+    static inline std::uint64_t key(std::uint64_t fingerprint) {
+        return fingerprint == 0 ? 1 : fingerprint;
+    }
+
+    // Index of the slot holding `k`, or of the empty slot where it would go.
+    inline std::size_t slot(std::uint64_t k) const {
+        std::size_t mask = slots.size() - 1;
+        std::size_t i = k & mask;
+        while (slots[i] != 0 && slots[i] != k) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    // Doubles the number of slots (or allocates the first ones).
+    void grow() {
+        std::vector<std::uint64_t> old(slots.size() == 0 ? 16
+                                                         : 2 * slots.size(),
+                                       0);
+        std::swap(old, slots);
+        for (std::uint64_t k : old) {
+            if (k != 0) {
+                slots[slot(k)] = k;
+            }
+        }
+    }
+
+  public:
+    FingerprintSet() : slots(), size(0) {}
+
+    /**
+     * @brief Checks membership.
+     *
+     * @param fingerprint A fingerprint.
+     * @return Whether `fingerprint` is in the set.
+     */
+    inline bool mem(std::uint64_t fingerprint) const {
+        return size != 0 && slots[slot(key(fingerprint))] != 0;
+    }
+
+    /**
+     * @brief Inserts a fingerprint.
+     *
+     * @param fingerprint A fingerprint.
+     * @return Whether `fingerprint` was not already in the set.
+     */
+    bool insert(std::uint64_t fingerprint) {
+        // Load factor is kept below one half.
+        if (2 * (size + 1) > slots.size()) {
+            grow();
+        }
+        std::uint64_t k = key(fingerprint);
+        std::size_t i = slot(k);
+        if (slots[i] != 0) {
+            return false;
+        }
+        slots[i] = k;
+        size++;
+        return true;
+    }
+
+    /**
+     * @brief Number of fingerprints in the set.
+     *
+     * @return std::size_t
+     */
+    inline std::size_t card() const { return size; }
+};
+
+/**
+ * @brief Visited set of a summit set search that only keeps fingerprints.
+ *
+ * Stands for a `SuperSummitSet` in `explore_super_summit`, or for an
+ * `UltraSummitTree` in `UltraSummitSearch`, when the set is enumerated rather
+ * than materialized: elements are hashed into a `FingerprintSet`, and the
+ * search tree (parents and conjugating elements) is dropped.
+ *
+ * @tparam B The braid class. `std::hash<B>` has to be defined.
+ */
+template <class B> class FingerprintVisited {
+
+  private:
+    FingerprintSet set;
+
+    static inline std::uint64_t fingerprint(const B &b) {
+        return std::hash<B>()(b);
+    }
+
+  public:
+    // Checks membership. May run concurrently.
+    inline bool mem(const B &b) const { return set.mem(fingerprint(b)); }
+
+    // Inserts `b`, returning whether it was not already there.
+    template <class I, class F> inline bool insert(const B &b, I, const F &) {
+        return set.insert(fingerprint(b));
+    }
+
+    // Inserts a whole orbit.
+    template <class I, class F>
+    inline void insert(std::vector<B> &&orbit, I, const F &) {
+        for (const B &b : orbit) {
+            set.insert(fingerprint(b));
+        }
+    }
+
+    inline std::size_t card() const { return set.card(); }
+};
+
+} // namespace garcide
+
+#endif
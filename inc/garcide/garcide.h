@@ -30,8 +30,12 @@
 #ifndef GARCIDE
 #define GARCIDE
 
+#include "garcide/ring_buffer.hpp"
 #include "garcide/utility.hpp"
+#include <atomic>
+#include <iterator>
 #include <list>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -41,6 +45,26 @@
  */
 namespace garcide {
 
+/**
+ * @brief Whether `U` has its own binary encoding (`to_bytes` and
+ * `of_bytes` methods).
+ */
+template <class U, class = void> struct HasBytes : std::false_type {};
+
+template <class U>
+struct HasBytes<U, std::void_t<decltype(std::declval<const U &>().to_bytes(
+                       std::declval<std::string &>()))>> : std::true_type {};
+
+/**
+ * @brief Whether `U` has its own total order (an `order` method, that
+ * returns a negative, zero or positive `int`).
+ */
+template <class U, class = void> struct HasOrder : std::false_type {};
+
+template <class U>
+struct HasOrder<U, std::void_t<decltype(std::declval<const U &>().order(
+                       std::declval<const U &>()))>> : std::true_type {};
+
 template <class U> class FactorTemplate {
 
   public:
@@ -92,6 +116,64 @@ template <class U> class FactorTemplate {
         underlying.of_string(str, pos);
     }
 
+    /**
+     * @brief Appends a binary encoding of `*this` to `bytes`.
+     *
+     * The underlying class's encoding is used if it has one. Otherwise,
+     * `*this` is written as a word in the atoms: its length, then the atoms'
+     * indexes in `atoms()`, as varints.
+     *
+     * @param bytes The byte string to append to.
+     */
+    void to_bytes(std::string &bytes) const {
+        if constexpr (HasBytes<U>::value) {
+            underlying.to_bytes(bytes);
+        } else {
+            std::vector<FactorTemplate> a = atoms();
+            std::vector<uint64> word;
+            FactorTemplate f = *this;
+            while (!f.is_identity()) {
+                uint64 i = 0;
+                while ((a[i] ^ f) != a[i]) {
+                    i++;
+                }
+                word.push_back(i);
+                f = a[i].right_complement(f);
+            }
+            append_varint(bytes, word.size());
+            for (uint64 i : word) {
+                append_varint(bytes, i);
+            }
+        }
+    }
+
+    /**
+     * @brief Extraction from a binary encoding.
+     *
+     * Reads what `to_bytes` wrote, starting at position `pos`.
+     *
+     * @param bytes The byte string to read from.
+     * @param pos The position to start from. It is set past the factor.
+     * @exception InvalidStringError Thrown when `bytes` does not hold a
+     * factor at `pos`.
+     */
+    void of_bytes(const std::string &bytes, size_t &pos) {
+        if constexpr (HasBytes<U>::value) {
+            underlying.of_bytes(bytes, pos);
+        } else {
+            std::vector<FactorTemplate> a = atoms();
+            uint64 length = read_varint(bytes, pos);
+            identity();
+            for (uint64 k = 0; k < length; k++) {
+                uint64 i = read_varint(bytes, pos);
+                if (i >= a.size()) {
+                    throw InvalidStringError("Invalid atom index!");
+                }
+                *this = *this * a[i];
+            }
+        }
+    }
+
     // a.debug(os) prints a's internal representation to os.
     void debug(IndentedOStream &os = ind_cout) const {
         os << "{   Underlying:";
@@ -123,6 +205,25 @@ template <class U> class FactorTemplate {
     // a != b returns true if a and b are not equal, false otherwise.
     bool operator!=(const FactorTemplate &b) const { return !compare(b); }
 
+    // a.order(b) is negative, zero or positive, depending on whether a comes
+    // before, is equal to, or comes after b in a fixed total order on
+    // factors: the underlying class's own order if it has one (on integer
+    // identifiers or packed words, typically), and otherwise that of their
+    // binary encodings (see `to_bytes`).
+    int order(const FactorTemplate &b) const {
+        if constexpr (HasOrder<U>::value) {
+            return underlying.order(b.underlying);
+        } else {
+            if (compare(b)) {
+                return 0;
+            }
+            std::string x, y;
+            to_bytes(x);
+            b.to_bytes(y);
+            return x.compare(y);
+        }
+    }
+
     // a.is_delta() returns whether a == e.
     bool is_identity() const {
         FactorTemplate e = FactorTemplate(*this);
@@ -336,6 +437,11 @@ template <class F> class BraidTemplate {
      */
     using Parameter = typename F::Parameter;
 
+    /**
+     * @brief The class of factors.
+     */
+    using Factor = F;
+
   private:
     /**
      * @brief A (group) parameter.
@@ -359,26 +465,58 @@ template <class F> class BraidTemplate {
      *
      * A list of the braid's canonical factors, from left to right. It is
      * left weighted when in LCF, and right weighted when in RCF.
+     *
+     * Factors are kept contiguous in a `RingBuffer`, as multiplications push
+     * and pop at both ends.
+     */
+    RingBuffer<F> factor_list;
+
+    /**
+     * @brief Cached value of `hash()`.
+     *
+     * `0` stands for unknown (a hash that happens to be `0` is stored as
+     * `1`). It is reset by every mutating method. Braids are hashed
+     * repeatedly while they sit in (or are looked up against) summit sets,
+     * and hashing walks the whole factor list.
      */
-    std::list<F> factor_list;
+    mutable std::atomic<std::size_t> hash_cache;
+
+    inline void invalidate_hash() {
+        hash_cache.store(0, std::memory_order_relaxed);
+    }
 
   public:
-    using FactorItr = typename std::list<F>::iterator;
-    using RevFactorItr = typename std::list<F>::reverse_iterator;
-    using ConstFactorItr = typename std::list<F>::const_iterator;
-    using ConstRevFactorItr = typename std::list<F>::const_reverse_iterator;
+    using FactorItr = typename RingBuffer<F>::iterator;
+    using RevFactorItr = typename RingBuffer<F>::reverse_iterator;
+    using ConstFactorItr = typename RingBuffer<F>::const_iterator;
+    using ConstRevFactorItr = typename RingBuffer<F>::const_reverse_iterator;
 
-    inline FactorItr begin() { return factor_list.begin(); }
+    // Non-const iterators may be used to modify factors, so getting one resets
+    // the cached hash. Writing through an iterator obtained before a call to
+    // `hash()` is not supported.
+    inline FactorItr begin() {
+        invalidate_hash();
+        return factor_list.begin();
+    }
 
-    inline RevFactorItr rbegin() { return factor_list.rbegin(); }
+    inline RevFactorItr rbegin() {
+        invalidate_hash();
+        return factor_list.rbegin();
+    }
 
     inline ConstFactorItr cbegin() const { return factor_list.begin(); }
 
     inline ConstRevFactorItr crbegin() const { return factor_list.rbegin(); }
 
-    inline FactorItr end() { return factor_list.end(); }
+    inline FactorItr end() {
+        invalidate_hash();
+        return factor_list.end();
+    }
 
-    inline RevFactorItr rend() { return factor_list.rend(); }
+    inline RevFactorItr rend() {
+        invalidate_hash();
+        return factor_list.rend();
+    }
 
     inline ConstFactorItr cend() const { return factor_list.end(); }
 
@@ -394,7 +532,7 @@ template <class F> class BraidTemplate {
      * @param parameter Group parameter.
      */
     BraidTemplate(Parameter parameter)
-        : parameter(parameter), delta(0), factor_list() {}
+        : parameter(parameter), delta(0), factor_list(), hash_cache(0) {}
 
     /**
      * @brief Construct a new BraidTemplate, from a factor.
@@ -404,7 +542,8 @@ template <class F> class BraidTemplate {
      * @param f FactorTemplate to be converted to a braid.
      */
     BraidTemplate(const F &f)
-        : parameter(f.get_parameter()), delta(0), factor_list() {
+        : parameter(f.get_parameter()), delta(0), factor_list(),
+          hash_cache(0) {
         if (f.is_delta()) {
             delta = 1;
         } else if (!f.is_identity()) {
@@ -412,6 +551,41 @@ template <class F> class BraidTemplate {
         }
     }
 
+    BraidTemplate(const BraidTemplate &v)
+        : parameter(v.parameter), delta(v.delta), factor_list(v.factor_list),
+          hash_cache(v.hash_cache.load(std::memory_order_relaxed)) {}
+
+    // Moves have to be `noexcept`, or containers of braids would copy them
+    // when they grow. The moved-from braid is left without factors, so its
+    // cached hash is reset.
+    BraidTemplate(BraidTemplate &&v) noexcept
+        : parameter(std::move(v.parameter)), delta(v.delta),
+          factor_list(std::move(v.factor_list)),
+          hash_cache(v.hash_cache.load(std::memory_order_relaxed)) {
+        v.invalidate_hash();
+    }
+
+    BraidTemplate &operator=(const BraidTemplate &v) {
+        parameter = v.parameter;
+        delta = v.delta;
+        factor_list = v.factor_list;
+        hash_cache.store(v.hash_cache.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+        return *this;
+    }
+
+    BraidTemplate &operator=(BraidTemplate &&v) noexcept {
+        parameter = std::move(v.parameter);
+        delta = v.delta;
+        factor_list = std::move(v.factor_list);
+        hash_cache.store(v.hash_cache.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+        if (this != &v) {
+            v.invalidate_hash();
+        }
+        return *this;
+    }
+
     inline static Parameter parameter_of_string(const std::string &str) {
         return F::parameter_of_string(str);
     }
@@ -425,7 +599,31 @@ template <class F> class BraidTemplate {
      *
      * @param delta The new value of `delta`.
      */
-    inline void set_delta(sint16 delta) { (*this).delta = delta; }
+    inline void set_delta(sint16 delta) {
+        (*this).delta = delta;
+        invalidate_hash();
+    }
+
+    /**
+     * @brief Sets the braid to a given LCF.
+     *
+     * Nothing is normalized: `inf` and the factors in `[first, last)` have
+     * to be the infimum and canonical factors of a braid in LCF.
+     *
+     * @tparam It A forward iterator type on factors.
+     * @param inf The new infimum.
+     * @param first An iterator on the first canonical factor.
+     * @param last An iterator past the last canonical factor.
+     */
+    template <class It> void assign_lcf(sint16 inf, It first, It last) {
+        delta = inf;
+        factor_list.clear();
+        factor_list.reserve(std::distance(first, last));
+        for (It it = first; it != last; it++) {
+            factor_list.push_back(*it);
+        }
+        invalidate_hash();
+    }
 
     /**
      * @brief Prints `*this` to `os`.
@@ -479,6 +677,7 @@ template <class F> class BraidTemplate {
     inline void identity() {
         delta = 0;
         factor_list.clear();
+        invalidate_hash();
     }
 
     // `u.canonical_length` returns u's canonical length.
@@ -502,6 +701,32 @@ template <class F> class BraidTemplate {
     // representation.
     bool operator!=(const BraidTemplate &v) const { return !compare(v); }
 
+    // `u.order(v)` is negative, zero or positive, depending on whether u
+    // comes before, is equal to, or comes after v in a fixed total order on
+    // braids in LCF: by infimum, then by canonical length, and then
+    // lexicographically on factors, ordered with `F::order`. Comparison stops
+    // at the first factor that differs.
+    int order(const BraidTemplate &v) const {
+        if (inf() != v.inf()) {
+            return inf() < v.inf() ? -1 : 1;
+        }
+        if (canonical_length() != v.canonical_length()) {
+            return canonical_length() < v.canonical_length() ? -1 : 1;
+        }
+        for (ConstFactorItr it = cbegin(), itv = v.cbegin(); it != cend();
+             it++, itv++) {
+            int o = (*it).order(*itv);
+            if (o != 0) {
+                return o;
+            }
+        }
+        return 0;
+    }
+
+    // `u < v` returns whether u comes before v in the order of `order`.
+    // Syntactic sugar for `u.order(v) < 0`.
+    bool operator<(const BraidTemplate &v) const { return order(v) < 0; }
+
     // `u.is_identity` returns whether u represents the identity element.
     bool is_identity() const { return delta == 0 && factor_list.empty(); }
 
@@ -589,6 +814,7 @@ template <class F> class BraidTemplate {
             left_multiply(*it);
         }
         delta += v.delta;
+        invalidate_hash();
     }
 
     // `u.right_multiply(v)` assigns u v to u.
@@ -645,6 +871,7 @@ template <class F> class BraidTemplate {
             right_multiply_rcf(*it);
         }
         delta += v.delta;
+        invalidate_hash();
     }
 
     // `u.left_divide(v)` assigns v ^ (- 1) u to u.
@@ -684,6 +911,8 @@ template <class F> class BraidTemplate {
             b1.delta -= b2.delta;
             b2.delta = 0;
         }
+        b1.invalidate_hash();
+        b2.invalidate_hash();
 
         while (!f.is_identity()) {
             if (b1.delta > 0) {
@@ -710,6 +939,7 @@ template <class F> class BraidTemplate {
         }
 
         b.delta -= shift;
+        b.invalidate_hash();
         return b;
     }
 
@@ -740,6 +970,8 @@ template <class F> class BraidTemplate {
             b1.delta -= b2.delta;
             b2.delta = 0;
         }
+        b1.invalidate_hash();
+        b2.invalidate_hash();
 
         b = b1;
 
@@ -761,6 +993,7 @@ template <class F> class BraidTemplate {
         }
 
         b.delta -= shift;
+        b.invalidate_hash();
         return b;
     }
 
@@ -883,6 +1116,7 @@ template <class F> class BraidTemplate {
         }
         F i = initial();
         factor_list.pop_front();
+        invalidate_hash();
         right_multiply(i);
     }
 
@@ -895,6 +1129,7 @@ template <class F> class BraidTemplate {
         }
         F f = final();
         factor_list.pop_back();
+        invalidate_hash();
         left_multiply(f);
     }
 
@@ -923,24 +1158,30 @@ template <class F> class BraidTemplate {
      * @brief Raises to `k`-th power.
      *
      * Computes `*this` raised to the `k`-th power, using a fast exponentiation
-     * algorithm.
+     * algorithm: the squares of `*this` (or of its inverse, if `k` is
+     * negative) are computed once each, and those that appear in the binary
+     * expansion of `|k|` are multiplied together. Powers of Delta are
+     * computed directly.
      *
      * @param k The exponent.
      * @return `*this` raised to the `k`-th power.
      */
     BraidTemplate power(const sint16 k) const {
-        if (k == 0) {
-            return BraidTemplate(get_parameter());
-        } else if (k % 2 == 0) {
-            BraidTemplate root = power(k / 2);
-            return root * root;
-        } else if (k > 0) {
-            BraidTemplate root = power(k / 2);
-            return *this * root * root;
-        } else {
-            BraidTemplate root = power(k / 2);
-            return !*this * root * root;
+        BraidTemplate result(get_parameter());
+        if (canonical_length() == 0) {
+            result.delta = delta * k;
+            return result;
+        }
+        BraidTemplate square = k >= 0 ? *this : inverse();
+        for (sint16 e = k >= 0 ? k : -k; e != 0; e /= 2) {
+            if (e % 2 == 1) {
+                result.right_multiply(square);
+            }
+            if (e > 1) {
+                square = square * square;
+            }
         }
+        return result;
     }
 
     // `u * v` returns uv.
@@ -1031,6 +1272,7 @@ template <class F> class BraidTemplate {
             f.randomize();
             factor_list.push_back(f);
         }
+        invalidate_hash();
     }
 
     void debug(IndentedOStream &os = ind_cout) const {
@@ -1067,14 +1309,69 @@ template <class F> class BraidTemplate {
         os << EndLine() << "}";
     }
 
+    /**
+     * @brief Hashes `*this`.
+     *
+     * The infimum and the factors' hashes are folded with `hash_combine`.
+     * The result is cached until `*this` is modified.
+     *
+     * @return A hash of `*this`.
+     */
     std::size_t hash() const {
-        std::size_t h = inf();
+        std::size_t h = hash_cache.load(std::memory_order_relaxed);
+        if (h != 0) {
+            return h;
+        }
+        h = hash_mix(uint64(sint64(inf())));
         for (ConstFactorItr it = cbegin(); it != cend(); it++) {
-            h = h * 31 + (*it).hash();
+            h = hash_combine(h, (*it).hash());
         }
+        h = h == 0 ? 1 : h;
+        hash_cache.store(h, std::memory_order_relaxed);
         return h;
     }
 
+    /**
+     * @brief Appends a binary encoding of `*this` to `bytes`.
+     *
+     * The infimum is written as a zigzag varint, followed by the canonical
+     * length as a varint, and by the canonical factors' encodings.
+     *
+     * @param bytes The byte string to append to.
+     */
+    void to_bytes(std::string &bytes) const {
+        sint64 i = inf();
+        append_varint(bytes, (uint64(i) << 1) ^ uint64(i >> 63));
+        append_varint(bytes, canonical_length());
+        for (ConstFactorItr it = cbegin(); it != cend(); it++) {
+            (*it).to_bytes(bytes);
+        }
+    }
+
+    /**
+     * @brief Extraction from a binary encoding.
+     *
+     * Reads what `to_bytes` wrote, starting at position `pos`, and sets
+     * `*this` to it. The factors are trusted to be in LCF.
+     *
+     * @param bytes The byte string to read from.
+     * @param pos The position to start from. It is set past the braid.
+     * @exception InvalidStringError Thrown when `bytes` does not hold a braid
+     * at `pos`.
+     */
+    void of_bytes(const std::string &bytes, size_t &pos) {
+        uint64 z = read_varint(bytes, pos);
+        sint16 i = sint16(sint64(z >> 1) ^ -sint64(z & 1));
+        uint64 length = read_varint(bytes, pos);
+        std::vector<F> factors;
+        F f(get_parameter());
+        for (uint64 k = 0; k < length; k++) {
+            f.of_bytes(bytes, pos);
+            factors.push_back(f);
+        }
+        assign_lcf(i, factors.begin(), factors.end());
+    }
+
     /**
      * @brief Conversion from string.
      *
@@ -1088,68 +1385,94 @@ template <class F> class BraidTemplate {
      * represented by regular expression `(W | .)* (((D | L) (W ^ W Z)?) (W
      * | .)*)*`
      *
+     * The string is read in a single pass, without any regular expression
+     * (see the lexing functions in `utility.hpp`).
+     *
      * @param str The string to convert from.
      * @exception InvalidStringError: Thrown when it isn't possible to
      * extract a factor from `str`, or when the factor we tried to extract
      * does not exist (e.g. `4` isn't a legal factor for artin braids on 4
      * strands).
      */
-    void of_string(const std::string str) {
+    void of_string(const std::string &str) {
         size_t pos = 0;
 
-        // We use double backslashes, as we want to obtain escape sequences.
-        // Otherwise, for instance, `\t` would be recognized as a tab by
-        // C++. For another example, `\^` would be recognized as an illegal
-        // escape sequence, and compilation would fail. If we wanted to
-        // recognize a single backslash `\`, we would have to escape it as
-        // `\\\\`. In C++ `std::regex`, `\s` is a whitespace, `\t` a tab,
-        // `\.` a dot and `\^` a chevron (`.` and `^` are special characters
-        // for `std::regex`).
-        std::regex ignore{"[\\s\\.\\t]*"};
-        std::regex power{"[\\s\\t]*\\^[\\s\\t]*(" + number_regex + ")"};
-        std::regex inverse{"![\\s\\t]*"};
-
         BraidTemplate b = *this;
         b.identity();
 
-        std::smatch match;
-
         F fact(get_parameter());
 
-        std::regex_search(str.begin() + pos, str.end(), match, ignore,
-                          std::regex_constants::match_continuous);
-        pos += match[0].length();
+        // Skips `(W | .)*`.
+        auto skip_separators = [&str, &pos]() {
+            while (pos < str.length() &&
+                   (is_whitespace(str[pos]) || str[pos] == '.')) {
+                pos++;
+            }
+        };
+
+        skip_separators();
 
         while (pos != str.length()) {
-            sint16 pow;
+            sint16 pow = 1;
 
             fact.of_string(str, pos);
 
-            if (std::regex_search(str.begin() + pos, str.end(), match, power,
-                                  std::regex_constants::match_continuous)) {
-                pos += match[0].length();
-                pow = std::stoi(match[1]);
-            } else {
-                pow = 1;
+            // Matches `W ^ W Z`, if present.
+            size_t end = pos;
+            StringSpan span;
+            skip_whitespaces(str, end);
+            if (match_char(str, end, '^')) {
+                skip_whitespaces(str, end);
+                if (match_integer(str, end, span)) {
+                    pos = end;
+                    pow = integer_of_string(str, span, "Exponent");
+                }
             }
-            if (pow >= 0) {
+            if (pow > 0 && !fact.is_delta()) {
                 for (sint16 _ = 0; _ < pow; _++) {
                     b.right_multiply(fact);
                 }
-            } else {
-                pow = -pow;
-                for (sint16 _ = 0; _ < pow; _++) {
-                    b.right_divide(fact);
-                }
+            } else if (pow == -1) {
+                b.right_divide(fact);
+            } else if (pow != 0) {
+                // Dividing by `fact` `-pow` times would conjugate the whole
+                // braid by Delta each time, which is quadratic in `pow`, and
+                // so is multiplying by Delta `pow` times.
+                b.right_multiply(BraidTemplate(fact).power(pow));
             }
-            std::regex_search(str.begin() + pos, str.end(), match, ignore,
-                              std::regex_constants::match_continuous);
-            pos += match[0].length();
+            skip_separators();
         }
         *this = b;
     }
 };
 
+/**
+ * @brief Converts a braid to another representation of its factors.
+ *
+ * `convert` has to send factors to factors representing the same simple
+ * elements. Left-weightedness is then preserved, so the images of `b`'s
+ * canonical factors are assigned as they are, without renormalizing.
+ *
+ * @tparam G The factor class of the result.
+ * @tparam F The factor class of `b`.
+ * @tparam Convert A function type, from `const F &` to `G`.
+ * @param b The braid to convert.
+ * @param convert The factor conversion.
+ * @return `b`, as a `BraidTemplate<G>`.
+ */
+template <class G, class F, class Convert>
+BraidTemplate<G> map_factors(const BraidTemplate<F> &b, Convert convert) {
+    std::vector<G> factors;
+    factors.reserve(b.canonical_length());
+    for (typename BraidTemplate<F>::ConstFactorItr it = b.cbegin();
+         it != b.cend(); it++) {
+        factors.push_back(convert(*it));
+    }
+    BraidTemplate<G> c(b.get_parameter());
+    c.assign_lcf(b.inf(), factors.begin(), factors.end());
+    return c;
+}
+
 // Overloading << for braid classes.
 template <class F>
 inline IndentedOStream &operator<<(IndentedOStream &os,
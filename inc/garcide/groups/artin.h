@@ -30,7 +30,11 @@
 #ifndef ARTIN
 #define ARTIN
 
+#include "garcide/invariants.h"
+#include "garcide/packed_underlying.hpp"
+#include "garcide/small_vector.hpp"
 #include "garcide/ultra_summit.h"
+#include <array>
 
 namespace garcide {
 
@@ -41,19 +45,21 @@ namespace garcide {
  */
 namespace artin {
 
+template <sint16 N> class FixedUnderlying;
+
 /// A class for the underlying objects for canonical factors
 /// in the Artin presentation braid group case.
 /// In this case, permutations.
 class Underlying {
 
+    template <sint16 N> friend class FixedUnderlying;
+
+    friend class PackedUnderlying<Underlying>;
+
   public:
     using Parameter = sint16;
 
   private:
-    Parameter number_of_strands;
-
-    std::vector<sint16> permutation_table;
-
     /**
      * @brief Maximum braid index.
      *
@@ -67,6 +73,25 @@ class Underlying {
      */
     static const sint16 MAX_NUMBER_OF_STRANDS = 256;
 
+    /**
+     * @brief Number of permutation table entries stored inline.
+     *
+     * Factors with fewer than `INLINE_CAPACITY` strands keep their
+     * permutation table inside the object, and are copied without allocating.
+     */
+    static const sint16 INLINE_CAPACITY = 32;
+
+    /**
+     * @brief Type of permutation table entries.
+     *
+     * The narrowest unsigned type that can hold `MAX_NUMBER_OF_STRANDS`.
+     */
+    using Entry = PermutationEntry<MAX_NUMBER_OF_STRANDS>;
+
+    Parameter number_of_strands;
+
+    SmallVector<Entry, INLINE_CAPACITY> permutation_table;
+
   public:
     static Parameter parameter_of_string(const std::string &str);
 
@@ -183,6 +208,27 @@ class Underlying {
 
     size_t hash() const;
 
+    /**
+     * @brief Appends a binary encoding of the factor to `bytes`.
+     *
+     * Images of the permutation are stored minus one, one per byte.
+     *
+     * @param bytes The byte string to append to.
+     */
+    void to_bytes(std::string &bytes) const;
+
+    /**
+     * @brief Extraction from a binary encoding.
+     *
+     * Reads what `to_bytes` wrote, starting at position `pos`.
+     *
+     * @param bytes The byte string to read from.
+     * @param pos The position to start from. It is set past the factor.
+     * @exception InvalidStringError Thrown when `bytes` ends before the
+     * factor does.
+     */
+    void of_bytes(const std::string &bytes, size_t &pos);
+
     /**
      * @brief Computes the tableau associated with a factor.
      *
@@ -201,7 +247,7 @@ class Underlying {
     Underlying inverse() const;
 
     // Subroutine called by left_meet() and right_meet().
-    static void MeetSub(const sint16 *a, const sint16 *b, sint16 *r, sint16 s,
+    static void MeetSub(const Entry *a, const Entry *b, Entry *r, sint16 s,
                         sint16 t);
 };
 
@@ -209,6 +255,309 @@ typedef FactorTemplate<Underlying> Factor;
 
 typedef BraidTemplate<Factor> Braid;
 
+static_assert(std::is_nothrow_move_constructible<Braid>::value &&
+                  std::is_nothrow_move_assignable<Braid>::value,
+              "Braids have to be moved, not copied, by growing vectors.");
+
+/**
+ * @brief Underlying objects for braids on a fixed number of strands.
+ *
+ * `FixedUnderlying<N>` implements the same Garside structure as `Underlying`,
+ * but its number of strands is the compile-time constant `N`. Its permutation
+ * table is a plain array of `N + 1` entries (of 8 bits whenever `N < 256`),
+ * so that factors never allocate, and the compiler can unroll and vectorize
+ * the loops of `product`, `inverse`, `delta_conjugate_mut` and the meets.
+ *
+ * Parsing is delegated to `Underlying`, and strings are read and printed the
+ * same way.
+ *
+ * @tparam N The number of strands.
+ */
+template <sint16 N> class FixedUnderlying {
+
+    static_assert(2 <= N, "Braids need at least 2 strands.");
+
+  public:
+    using Parameter = sint16;
+
+  private:
+    using Entry = PermutationEntry<N>;
+
+    std::array<Entry, N + 1> permutation_table;
+
+    // Subroutine called by left_meet() and right_meet().
+    // Same as `Underlying::MeetSub`, with scratch arrays on the stack.
+    static void MeetSub(const Entry *a, const Entry *b, Entry *r, sint16 s,
+                        sint16 t) {
+        Entry u[N + 1], v[N + 1], w[N + 1];
+
+        if (s >= t)
+            return;
+        sint16 m = (s + t) / 2;
+        MeetSub(a, b, r, s, m);
+        MeetSub(a, b, r, m + 1, t);
+
+        u[m] = a[r[m]];
+        v[m] = b[r[m]];
+        if (s < m) {
+            for (sint16 i = m - 1; i >= s; --i) {
+                u[i] = std::min(a[r[i]], u[i + 1]);
+                v[i] = std::min(b[r[i]], v[i + 1]);
+            }
+        }
+        u[m + 1] = a[r[m + 1]];
+        v[m + 1] = b[r[m + 1]];
+        if (t > m + 1) {
+            for (sint16 i = m + 2; i <= t; ++i) {
+                u[i] = std::max(a[r[i]], u[i - 1]);
+                v[i] = std::max(b[r[i]], v[i - 1]);
+            }
+        }
+
+        sint16 p = s;
+        sint16 q = m + 1;
+        for (sint16 i = s; i <= t; ++i)
+            w[i] = ((p > m) || (q <= t && u[p] > u[q] && v[p] > v[q]))
+                       ? r[q++]
+                       : r[p++];
+        for (sint16 i = s; i <= t; ++i)
+            r[i] = w[i];
+    }
+
+    // Computes the factor corresponding to the inverse permutation.
+    // Used to simplify complement operation.
+    FixedUnderlying inverse() const {
+        FixedUnderlying f;
+        for (sint16 i = 1; i <= N; i++) {
+            f.permutation_table[permutation_table[i]] = i;
+        }
+        return f;
+    }
+
+  public:
+    /**
+     * @brief Parses a number of strands.
+     *
+     * Same as `Underlying::parameter_of_string`, except that the only
+     * accepted value is `N`.
+     *
+     * @param str The string to parse.
+     * @exception InvalidStringError Thrown when `str` does not represent `N`.
+     * @return `N`.
+     */
+    static Parameter parameter_of_string(const std::string &str) {
+        if (Underlying::parameter_of_string(str) != N) {
+            throw InvalidStringError("Number of strands should be " +
+                                     std::to_string(N) + "!");
+        }
+        return N;
+    }
+
+    Parameter get_parameter() const { return N; }
+
+    sint16 at(size_t i) const { return permutation_table[i]; }
+
+    /**
+     * @brief Construct a new `FixedUnderlying`.
+     *
+     * Its `permutation_table` is filled with zeros (thus this is not a valid
+     * factor). Initialize it with `identity`, `delta`, or another similar
+     * method.
+     *
+     * The parameter is only there so that `FixedUnderlying` may be used as
+     * `Underlying`.
+     */
+    FixedUnderlying(Parameter = N) : permutation_table() {}
+
+    /**
+     * @brief Conversion from `Underlying`.
+     *
+     * @param u A factor on `N` strands.
+     */
+    explicit FixedUnderlying(const Underlying &u) : permutation_table() {
+        for (sint16 i = 1; i <= N; i++) {
+            permutation_table[i] = u.permutation_table[i];
+        }
+    }
+
+    /**
+     * @brief Conversion to `Underlying`.
+     *
+     * @return The same factor, as an `Underlying`.
+     */
+    Underlying to_underlying() const {
+        Underlying u(N);
+        for (sint16 i = 1; i <= N; i++) {
+            u.permutation_table[i] = permutation_table[i];
+        }
+        return u;
+    }
+
+    void of_string(const std::string &str, size_t &pos) {
+        Underlying u(N);
+        u.of_string(str, pos);
+        *this = FixedUnderlying(u);
+    }
+
+    sint16 lattice_height() const { return N * (N - 1) / 2; }
+
+    void debug(IndentedOStream &os) const { to_underlying().debug(os); }
+
+    void print(IndentedOStream &os) const { to_underlying().print(os); }
+
+    // Set to the identity element (here the identity).
+    void identity() {
+        for (sint16 i = 1; i <= N; i++) {
+            permutation_table[i] = i;
+        }
+    }
+
+    // Set to delta.
+    void delta() {
+        for (sint16 i = 1; i <= N; i++) {
+            permutation_table[i] = N + 1 - i;
+        }
+    }
+
+    FixedUnderlying left_meet(const FixedUnderlying &b) const {
+        Entry s[N + 1];
+
+        FixedUnderlying f;
+
+        for (sint16 i = 1; i <= N; ++i)
+            s[i] = i;
+        MeetSub(permutation_table.data(), b.permutation_table.data(), s, 1, N);
+        for (sint16 i = 1; i <= N; ++i)
+            f.permutation_table[s[i]] = i;
+
+        return f;
+    }
+
+    FixedUnderlying right_meet(const FixedUnderlying &b) const {
+        Entry u[N + 1], v[N + 1];
+
+        FixedUnderlying f;
+
+        for (sint16 i = 1; i <= N; ++i) {
+            u[permutation_table[i]] = i;
+            v[b.permutation_table[i]] = i;
+        }
+        for (sint16 i = 1; i <= N; ++i)
+            f.permutation_table[i] = i;
+        MeetSub(u, v, f.permutation_table.data(), 1, N);
+
+        return f;
+    }
+
+    // Equality check.
+    // Entry 0 is never set, so whole tables can be compared.
+    bool compare(const FixedUnderlying &b) const {
+        return permutation_table == b.permutation_table;
+    }
+
+    // product under the hypothesis that it is still simple.
+    FixedUnderlying product(const FixedUnderlying &b) const {
+        FixedUnderlying f;
+        for (sint16 i = 1; i <= N; i++) {
+            f.permutation_table[i] = b.permutation_table[permutation_table[i]];
+        }
+        return f;
+    }
+
+    // Under the assumption a <= b, a.left_complement(b) computes
+    // The factor c such that ac = b.
+    FixedUnderlying left_complement(const FixedUnderlying &b) const {
+        return b.product(inverse());
+    }
+
+    FixedUnderlying right_complement(const FixedUnderlying &b) const {
+        return inverse().product(b);
+    }
+
+    // Generate a random factor.
+    void randomize() {
+        identity();
+        for (sint16 i = 1; i < N; ++i) {
+            sint16 j =
+                i + sint16(std::rand() / (RAND_MAX + 1.0) * (N - i + 1));
+            std::swap(permutation_table[i], permutation_table[j]);
+        }
+    }
+
+    // List of atoms.
+    std::vector<FixedUnderlying> atoms() const {
+        FixedUnderlying atom;
+        std::vector<FixedUnderlying> atoms;
+        for (sint16 i = 1; i <= N - 1; i++) {
+            atom.identity();
+            atom.permutation_table[i] = i + 1;
+            atom.permutation_table[i + 1] = i;
+            atoms.push_back(atom);
+        }
+        return atoms;
+    }
+
+    // Conjugate by delta^k.
+    void delta_conjugate_mut(sint16 k) {
+        if (k % 2 != 0) {
+            FixedUnderlying f;
+            for (sint16 i = 1; i <= N; i++) {
+                f.permutation_table[i] =
+                    N + 1 - permutation_table[N + 1 - i];
+            }
+            *this = f;
+        }
+    }
+
+    // Factors are ordered lexicographically by their permutation tables.
+    int order(const FixedUnderlying &b) const {
+        for (sint16 i = 1; i <= N; i++) {
+            if (permutation_table[i] != b.permutation_table[i]) {
+                return permutation_table[i] < b.permutation_table[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    size_t hash() const {
+        return hash_bytes(permutation_table.data() + 1, N * sizeof(Entry));
+    }
+};
+
+typedef FactorTemplate<PackedUnderlying<Underlying>> PackedFactor;
+
+typedef BraidTemplate<PackedFactor> PackedBraid;
+
+template <sint16 N> using FixedFactor = FactorTemplate<FixedUnderlying<N>>;
+
+template <sint16 N> using FixedBraid = BraidTemplate<FixedFactor<N>>;
+
+/**
+ * @brief Converts a braid to a braid on a fixed number of strands.
+ *
+ * @tparam N The number of strands of `b`.
+ * @param b The braid to convert.
+ * @return `b`, as a `FixedBraid<N>`.
+ */
+template <sint16 N> FixedBraid<N> to_fixed(const Braid &b) {
+    return map_factors<FixedFactor<N>>(b, [](const Factor &f) {
+        return FixedFactor<N>(FixedUnderlying<N>(f.get_underlying()));
+    });
+}
+
+/**
+ * @brief Converts a braid on a fixed number of strands to a `Braid`.
+ *
+ * @tparam N The number of strands of `fb`.
+ * @param fb The braid to convert.
+ * @return `fb`, as a `Braid`.
+ */
+template <sint16 N> Braid of_fixed(const FixedBraid<N> &fb) {
+    return map_factors<Factor>(fb, [](const FixedFactor<N> &f) {
+        return Factor(f.get_underlying().to_underlying());
+    });
+}
+
 /**
  * @brief Enum for Thurston types.
  *
@@ -248,6 +597,58 @@ ThurstonType thurston_type(const Braid &b,
  */
 ThurstonType thurston_type(const Braid &b);
 
+/**
+ * @brief Exponent sum of a braid.
+ *
+ * That is, the image of `b` by the morphism that sends every Artin generator
+ * to `1`. It is a conjugacy invariant.
+ *
+ * @param b A braid.
+ * @return `b`'s exponent sum.
+ */
+sint32 exponent_sum(const Braid &b);
+
+/**
+ * @brief Trace of the Burau representation of a braid, at some point.
+ *
+ * The unreduced Burau matrix of `b` is evaluated at `t`, modulo the prime
+ * `2^31 - 1`, and its trace is returned. It is a conjugacy invariant.
+ *
+ * @param b A braid.
+ * @param t A non-zero residue modulo `2^31 - 1`.
+ * @return The trace of the Burau matrix of `b` at `t`, modulo `2^31 - 1`.
+ */
+uint64 burau_trace(const Braid &b, uint64 t);
+
+/**
+ * @brief Adds conjugacy invariants of braids to a pipeline.
+ *
+ * In that order: the exponent sum, the cycle type of the induced
+ * permutation, and the trace of the Burau representation at a fixed point.
+ * Each takes linear time in the canonical length (times a power of the
+ * number of strands).
+ *
+ * @param filter The pipeline to add them to.
+ */
+void add_invariants(InvariantFilter<Braid> &filter);
+
+/**
+ * @brief Adds conjugacy invariants of braids to a pipeline, for the other
+ * representations of factors.
+ *
+ * Those of `add_invariants(InvariantFilter<Braid> &)`, run on braids that are
+ * converted to `Braid` first. This covers `FixedBraid<N>` and `PackedBraid`,
+ * as well as tabulated and interned factors.
+ *
+ * @tparam U Another representation of `Underlying`.
+ * @param filter The pipeline to add them to.
+ */
+template <class U,
+          std::enable_if_t<Represents<U, Underlying>::value, int> = 0>
+void add_invariants(InvariantFilter<BraidTemplate<FactorTemplate<U>>> &filter) {
+    add_underlying_invariants<Underlying>(filter);
+}
+
 } // namespace artin
 
 /**
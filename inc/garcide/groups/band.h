@@ -31,6 +31,9 @@
 #define BAND
 
 #include "garcide/garcide.h"
+#include "garcide/invariants.h"
+#include "garcide/packed_underlying.hpp"
+#include "garcide/small_vector.hpp"
 
 #ifdef USE_CLN
 
@@ -41,15 +44,12 @@
 namespace garcide::band {
 
 class Underlying {
-  public:
-    using Parameter = sint16;
-
-  private:
-    Parameter number_of_strands;
 
-    std::vector<sint16> permutation_table;
+    friend class PackedUnderlying<Underlying>;
 
   public:
+    using Parameter = sint16;
+
     /**
      * @brief Maximum braid index.
      *
@@ -63,6 +63,27 @@ class Underlying {
      */
     static const Parameter MAX_NUMBER_OF_STRANDS = 256;
 
+  private:
+    /**
+     * @brief Number of permutation table entries stored inline.
+     *
+     * Factors with fewer than `INLINE_CAPACITY` strands keep their
+     * permutation table inside the object, and are copied without allocating.
+     */
+    static const sint16 INLINE_CAPACITY = 32;
+
+    /**
+     * @brief Type of permutation table entries.
+     *
+     * The narrowest unsigned type that can hold `MAX_NUMBER_OF_STRANDS`.
+     */
+    using Entry = PermutationEntry<MAX_NUMBER_OF_STRANDS>;
+
+    Parameter number_of_strands;
+
+    SmallVector<Entry, INLINE_CAPACITY> permutation_table;
+
+  public:
     static Parameter parameter_of_string(const std::string &str);
 
     Parameter get_parameter() const;
@@ -156,6 +177,27 @@ class Underlying {
 
     size_t hash() const;
 
+    /**
+     * @brief Appends a binary encoding of the factor to `bytes`.
+     *
+     * Images of the permutation are stored minus one, one per byte.
+     *
+     * @param bytes The byte string to append to.
+     */
+    void to_bytes(std::string &bytes) const;
+
+    /**
+     * @brief Extraction from a binary encoding.
+     *
+     * Reads what `to_bytes` wrote, starting at position `pos`.
+     *
+     * @param bytes The byte string to read from.
+     * @param pos The position to start from. It is set past the factor.
+     * @exception InvalidStringError Thrown when `bytes` ends before the
+     * factor does.
+     */
+    void of_bytes(const std::string &bytes, size_t &pos);
+
     void of_ballot_sequence(const sint8 *s);
 };
 
@@ -163,6 +205,48 @@ typedef FactorTemplate<Underlying> Factor;
 
 typedef BraidTemplate<Factor> Braid;
 
+typedef FactorTemplate<PackedUnderlying<Underlying>> PackedFactor;
+
+typedef BraidTemplate<PackedFactor> PackedBraid;
+
+/**
+ * @brief Exponent sum of a braid.
+ *
+ * That is, the image of `b` by the morphism that sends every band generator
+ * to `1` (which is also its exponent sum as an Artin braid). It is a
+ * conjugacy invariant.
+ *
+ * @param b A braid.
+ * @return `b`'s exponent sum.
+ */
+sint32 exponent_sum(const Braid &b);
+
+/**
+ * @brief Adds conjugacy invariants of braids to a pipeline.
+ *
+ * In that order: the exponent sum, and the cycle type of the induced
+ * permutation.
+ *
+ * @param filter The pipeline to add them to.
+ */
+void add_invariants(InvariantFilter<Braid> &filter);
+
+/**
+ * @brief Adds conjugacy invariants of braids to a pipeline, for the other
+ * representations of factors.
+ *
+ * Those of `add_invariants(InvariantFilter<Braid> &)`, run on braids that are
+ * converted to `Braid` first (packed, tabulated and interned factors).
+ *
+ * @tparam U Another representation of `Underlying`.
+ * @param filter The pipeline to add them to.
+ */
+template <class U,
+          std::enable_if_t<Represents<U, Underlying>::value, int> = 0>
+void add_invariants(InvariantFilter<BraidTemplate<FactorTemplate<U>>> &filter) {
+    add_underlying_invariants<Underlying>(filter);
+}
+
 #ifdef USE_CLN
 
 void ballot_sequence(sint16 n, cln::cl_I k, sint8 *s);
@@ -97,9 +97,9 @@ public:
     // Used to speed up calculations compared to default implementation.
     Underlying delta_conjugate_mut(sint16 k) const;
 
+    // `point` is only meaningful for atoms.
     inline std::size_t hash() const {
-        std::size_t h = point;
-        return h;
+        return hash_combine(type, type == 2 ? point : 0);
     }
 };
 
@@ -0,0 +1,408 @@
+/**
+ * @file interned_underlying.hpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header (and implementation) file for interned factors.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INTERNED_UNDERLYING
+#define INTERNED_UNDERLYING
+
+#include "garcide/garcide.h"
+#include "garcide/shared_table.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace garcide {
+
+/**
+ * @brief Interned factors.
+ *
+ * `InternedUnderlying<U>` implements the same Garside structure as `U`, but
+ * each distinct value of `U` is stored only once, in a table shared by all
+ * factors with the same parameter, and factors are 32-bit identifiers into
+ * that table (plus a pointer to it).
+ *
+ * Summit sets hold many copies of few simple elements: with interned
+ * factors, each copy costs 16 bytes whatever `U` is. Comparing and hashing
+ * factors are word operations, so that hashing a braid takes time linear in
+ * its canonical length only.
+ *
+ * Every other operation is first looked up by its operands' identifiers in
+ * a small per-thread cache, so that in the common case it takes no lock and
+ * no call to `U`. Otherwise it is carried out by `U` on the stored values,
+ * and its result is interned, which takes a hash table lookup under a shared
+ * lock (and an exclusive one when the value is new). Unlike
+ * `TabulatedUnderlying`, nothing is enumerated beforehand, so this works for
+ * any parameter.
+ *
+ * @tparam U The underlying class whose values are interned.
+ */
+template <class U> class InternedUnderlying {
+
+  public:
+    using Parameter = typename U::Parameter;
+
+  private:
+    /**
+     * @brief Values are stored in chunks of `1 << CHUNK_BITS` values, which
+     * never move once allocated.
+     */
+    static const std::uint32_t CHUNK_BITS = 16;
+
+    static const std::uint32_t CHUNK_SIZE = std::uint32_t(1) << CHUNK_BITS;
+
+    static const std::uint32_t NUMBER_OF_CHUNKS =
+        std::uint32_t(1) << (32 - CHUNK_BITS);
+
+    struct Hash {
+        std::size_t operator()(const U *u) const { return u->hash(); }
+    };
+
+    struct Equal {
+        bool operator()(const U *u, const U *v) const {
+            return u->compare(*v);
+        }
+    };
+
+    /**
+     * @brief The interned values of a parameter.
+     */
+    struct Table {
+        Parameter parameter;
+
+        mutable std::shared_mutex mutex;
+
+        /**
+         * @brief Number of interned values.
+         */
+        mutable std::uint64_t size;
+
+        mutable std::unique_ptr<std::atomic<U *>[]> chunks;
+
+        /**
+         * @brief Identifiers of interned values.
+         *
+         * Keys point into `chunks`.
+         */
+        mutable std::unordered_map<const U *, std::uint32_t, Hash, Equal> ids;
+
+        std::uint32_t identity;
+
+        std::uint32_t delta;
+
+        explicit Table(const Parameter &p)
+            : parameter(p), size(0),
+              chunks(new std::atomic<U *>[NUMBER_OF_CHUNKS]) {
+            for (std::uint32_t c = 0; c < NUMBER_OF_CHUNKS; c++) {
+                chunks[c].store(nullptr, std::memory_order_relaxed);
+            }
+            U u(p);
+            u.identity();
+            identity = intern(u);
+            u.delta();
+            delta = intern(u);
+        }
+
+        ~Table() {
+            std::allocator<U> allocator;
+            for (std::uint64_t i = 0; i < size; i++) {
+                value(std::uint32_t(i)).~U();
+            }
+            for (std::uint32_t c = 0; c < NUMBER_OF_CHUNKS; c++) {
+                U *chunk = chunks[c].load(std::memory_order_relaxed);
+                if (chunk != nullptr) {
+                    allocator.deallocate(chunk, CHUNK_SIZE);
+                }
+            }
+        }
+
+        const U &value(std::uint32_t id) const {
+            return chunks[id >> CHUNK_BITS].load(
+                std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+        }
+
+        std::uint32_t intern(const U &u) const {
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex);
+                auto it = ids.find(&u);
+                if (it != ids.end()) {
+                    return it->second;
+                }
+            }
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            auto it = ids.find(&u);
+            if (it != ids.end()) {
+                return it->second;
+            }
+            if (size == std::uint64_t(NUMBER_OF_CHUNKS) * CHUNK_SIZE) {
+                throw std::length_error("Too many interned factors!");
+            }
+            std::uint32_t id = std::uint32_t(size);
+            U *chunk = chunks[id >> CHUNK_BITS].load(std::memory_order_relaxed);
+            if (chunk == nullptr) {
+                chunk = std::allocator<U>().allocate(CHUNK_SIZE);
+                chunks[id >> CHUNK_BITS].store(chunk,
+                                               std::memory_order_release);
+            }
+            U *v = ::new (static_cast<void *>(chunk + (id & (CHUNK_SIZE - 1))))
+                U(u);
+            size++;
+            ids.emplace(v, id);
+            return id;
+        }
+    };
+
+    /**
+     * @brief Operations whose results are memoized.
+     */
+    enum class Operation : std::uint32_t {
+        LeftMeet,
+        RightMeet,
+        Product,
+        LeftComplement,
+        RightComplement,
+        DeltaConjugate
+    };
+
+    /**
+     * @brief A direct-mapped cache of operation results, by operand
+     * identifiers.
+     *
+     * There is one per thread, so it is read and written without
+     * synchronization. Colliding entries simply overwrite each other.
+     */
+    struct Memo {
+        static const std::uint32_t BITS = 13;
+
+        struct Entry {
+            const Table *table = nullptr;
+            std::uint32_t a, b;
+            Operation op;
+            std::uint32_t result;
+        };
+
+        Entry entries[std::size_t(1) << BITS];
+
+        // Allocated on the heap, as large `thread_local` objects eat into
+        // thread stacks.
+        static Memo &local() {
+            thread_local std::unique_ptr<Memo> memo(new Memo());
+            return *memo;
+        }
+
+        Entry &slot(const Table *table, std::uint32_t a, std::uint32_t b,
+                    Operation op) {
+            uint64 h = hash_combine(
+                hash_combine(hash_mix(reinterpret_cast<std::uintptr_t>(table)),
+                             (uint64(a) << 32) | b),
+                uint64(op));
+            return entries[h >> (64 - BITS)];
+        }
+    };
+
+    const Table *table;
+
+    std::uint32_t id;
+
+    InternedUnderlying(const Table *table, std::uint32_t id)
+        : table(table), id(id) {}
+
+    inline InternedUnderlying intern(const U &u) const {
+        return InternedUnderlying(table, table->intern(u));
+    }
+
+    // The identifier of `op` applied to `id` and `b`, computed by `compute`
+    // (that returns a `U`) if it is not in this thread's memo.
+    template <class Compute>
+    inline std::uint32_t memoized(Operation op, std::uint32_t b,
+                                  Compute compute) const {
+        typename Memo::Entry &e = Memo::local().slot(table, id, b, op);
+        if (e.table != table || e.a != id || e.b != b || e.op != op) {
+            e.result = table->intern(compute());
+            e.table = table;
+            e.a = id;
+            e.b = b;
+            e.op = op;
+        }
+        return e.result;
+    }
+
+    // `op` (a member function of `U`) applied to `*this` and `b`.
+    template <class Method>
+    inline InternedUnderlying apply(Operation op, Method method,
+                                    const InternedUnderlying &b) const {
+        return InternedUnderlying(
+            table, memoized(op, b.id, [&]() {
+                return (to_underlying().*method)(b.to_underlying());
+            }));
+    }
+
+  public:
+    static Parameter parameter_of_string(const std::string &str) {
+        return U::parameter_of_string(str);
+    }
+
+    Parameter get_parameter() const { return table->parameter; }
+
+    /**
+     * @brief Construct a new `InternedUnderlying`.
+     *
+     * Unlike `U`, it is initialized to the identity.
+     *
+     * @param p The parameter.
+     */
+    InternedUnderlying(Parameter p)
+        : table(shared_table<Table>(p)), id(table->identity) {}
+
+    /**
+     * @brief Conversion from `U`.
+     *
+     * @param u A simple element.
+     */
+    explicit InternedUnderlying(const U &u)
+        : table(shared_table<Table>(u.get_parameter())),
+          id(table->intern(u)) {}
+
+    /**
+     * @brief Conversion to `U`.
+     *
+     * @return The same factor, as a `U`.
+     */
+    const U &to_underlying() const { return table->value(id); }
+
+    void of_string(const std::string &str, size_t &pos) {
+        U u(get_parameter());
+        u.of_string(str, pos);
+        id = table->intern(u);
+    }
+
+    sint16 lattice_height() const { return to_underlying().lattice_height(); }
+
+    void debug(IndentedOStream &os) const { to_underlying().debug(os); }
+
+    void print(IndentedOStream &os) const { to_underlying().print(os); }
+
+    void identity() { id = table->identity; }
+
+    void delta() { id = table->delta; }
+
+    InternedUnderlying left_meet(const InternedUnderlying &b) const {
+        return apply(Operation::LeftMeet, &U::left_meet, b);
+    }
+
+    InternedUnderlying right_meet(const InternedUnderlying &b) const {
+        return apply(Operation::RightMeet, &U::right_meet, b);
+    }
+
+    bool compare(const InternedUnderlying &b) const { return id == b.id; }
+
+    // product under the hypothesis that it is still simple.
+    InternedUnderlying product(const InternedUnderlying &b) const {
+        return apply(Operation::Product, &U::product, b);
+    }
+
+    InternedUnderlying left_complement(const InternedUnderlying &b) const {
+        return apply(Operation::LeftComplement, &U::left_complement, b);
+    }
+
+    InternedUnderlying right_complement(const InternedUnderlying &b) const {
+        return apply(Operation::RightComplement, &U::right_complement, b);
+    }
+
+    void randomize() {
+        U u(get_parameter());
+        u.randomize();
+        id = table->intern(u);
+    }
+
+    std::vector<InternedUnderlying> atoms() const {
+        std::vector<InternedUnderlying> atoms;
+        for (const U &a : to_underlying().atoms()) {
+            atoms.push_back(intern(a));
+        }
+        return atoms;
+    }
+
+    void delta_conjugate_mut(sint16 k) {
+        id = memoized(Operation::DeltaConjugate, std::uint32_t(k), [&]() {
+            U u = to_underlying();
+            u.delta_conjugate_mut(k);
+            return u;
+        });
+    }
+
+    // Factors are ordered by their identifiers. These depend on the order in
+    // which values were first interned, so that this order is only fixed
+    // within a run of the program.
+    int order(const InternedUnderlying &b) const {
+        return id < b.id ? -1 : id > b.id ? 1 : 0;
+    }
+
+    size_t hash() const { return hash_mix(id); }
+};
+
+/**
+ * @brief Converts a braid to a braid with interned factors.
+ *
+ * @tparam U The underlying class of `b`.
+ * @param b The braid to convert.
+ * @return `b`, as a braid with `InternedUnderlying<U>` factors.
+ */
+template <class U>
+BraidTemplate<FactorTemplate<InternedUnderlying<U>>>
+to_interned(const BraidTemplate<FactorTemplate<U>> &b) {
+    return map_factors<FactorTemplate<InternedUnderlying<U>>>(
+        b, [](const FactorTemplate<U> &f) {
+            return FactorTemplate<InternedUnderlying<U>>(
+                InternedUnderlying<U>(f.get_underlying()));
+        });
+}
+
+/**
+ * @brief Converts a braid with interned factors back to its usual
+ * representation.
+ *
+ * @tparam U The underlying class of the result.
+ * @param ib The braid to convert.
+ * @return `ib`, as a braid with `U` factors.
+ */
+template <class U>
+BraidTemplate<FactorTemplate<U>>
+of_interned(const BraidTemplate<FactorTemplate<InternedUnderlying<U>>> &ib) {
+    return map_factors<FactorTemplate<U>>(
+        ib, [](const FactorTemplate<InternedUnderlying<U>> &f) {
+            return FactorTemplate<U>(f.get_underlying().to_underlying());
+        });
+}
+
+} // namespace garcide
+
+#endif
@@ -0,0 +1,285 @@
+/**
+ * @file invariants.h
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header file for conjugacy invariants.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INVARIANTS
+#define INVARIANTS
+
+#include "garcide/garcide.h"
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace garcide {
+
+/**
+ * @brief A pipeline of cheap conjugacy tests.
+ *
+ * Each test is given two braids, and returns `false` only if they cannot be
+ * conjugate (typically, because some conjugacy invariant takes different
+ * values on them). Tests are run in the order they were added, and the
+ * first one that returns `false` decides. Conjugacy tests run such a
+ * pipeline before sending their arguments to a summit set, so that most
+ * non-conjugate pairs never get there.
+ *
+ * The default pipeline of a braid class is returned by
+ * `default_invariant_filter`, and is built by the `add_invariants` function
+ * of its group (if any).
+ *
+ * @tparam B A braid class.
+ */
+template <class B> class InvariantFilter {
+
+  public:
+    using Test = std::function<bool(const B &, const B &)>;
+
+  private:
+    template <class C> friend class InvariantFilter;
+
+    std::vector<std::pair<std::string, Test>> tests;
+
+  public:
+    InvariantFilter() : tests() {}
+
+    /**
+     * @brief Appends a test to the pipeline.
+     *
+     * @param name The name of the test, that is reported when it decides.
+     * @param test A function that returns `false` only on pairs of braids
+     * that are not conjugate.
+     */
+    void add(const std::string &name, const Test &test) {
+        tests.emplace_back(name, test);
+    }
+
+    /**
+     * @brief Appends a test that compares the values of a conjugacy invariant.
+     *
+     * @tparam Invariant A class of functions of signature `T _(const B &)`,
+     * where `T` is equality comparable.
+     * @param name The name of the invariant, that is reported when it decides.
+     * @param invariant A function that takes the same value on conjugate
+     * braids.
+     */
+    template <class Invariant>
+    void add_invariant(const std::string &name, Invariant invariant) {
+        add(name, [invariant](const B &u, const B &v) {
+            return invariant(u) == invariant(v);
+        });
+    }
+
+    /**
+     * @brief Appends the tests of a pipeline on another braid class.
+     *
+     * Braids are converted before they are handed to these tests, which keep
+     * their names.
+     *
+     * @tparam C The braid class of `filter`.
+     * @tparam Convert A function type, from `const B &` to `C`.
+     * @param filter The pipeline whose tests are appended.
+     * @param convert The conversion.
+     */
+    template <class C, class Convert>
+    void add_converted(const InvariantFilter<C> &filter, Convert convert) {
+        for (const std::pair<std::string, typename InvariantFilter<C>::Test>
+                 &test : filter.tests) {
+            typename InvariantFilter<C>::Test t = test.second;
+            add(test.first, [t, convert](const B &u, const B &v) {
+                return t(convert(u), convert(v));
+            });
+        }
+    }
+
+    inline size_t size() const { return tests.size(); }
+
+    /**
+     * @brief Runs the pipeline.
+     *
+     * @param u A braid.
+     * @param v A braid.
+     * @param decided_by Set to the name of the test that tells `u` and `v`
+     * apart, if there is one.
+     * @return `false` if some test tells `u` and `v` apart (they are then not
+     * conjugate), `true` otherwise.
+     */
+    bool may_be_conjugate(const B &u, const B &v,
+                          std::string &decided_by) const {
+        for (const std::pair<std::string, Test> &test : tests) {
+            if (!test.second(u, v)) {
+                decided_by = test.first;
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Adds a group's conjugacy invariants to a pipeline.
+ *
+ * This is the fallback, for groups that do not provide any: it does nothing.
+ * Groups provide theirs by overloading it in their namespace (see
+ * `artin::add_invariants`), where it is found by argument-dependent lookup.
+ * Groups that do should also cover the other representations of their
+ * factors (see `add_underlying_invariants`), as these would otherwise fall
+ * back to an empty pipeline.
+ *
+ * @tparam B A braid class.
+ */
+template <class B> void add_invariants(InvariantFilter<B> &) {}
+
+/**
+ * @brief The default pipeline of a braid class.
+ *
+ * It is built once, by `add_invariants`.
+ *
+ * @tparam B A braid class.
+ * @return A reference to it.
+ */
+template <class B> const InvariantFilter<B> &default_invariant_filter() {
+    static const InvariantFilter<B> filter = []() {
+        InvariantFilter<B> f;
+        add_invariants(f);
+        return f;
+    }();
+    return filter;
+}
+
+/**
+ * @brief Whether `U` is another representation of the simple elements of
+ * `V`, _i.e._ it has a `to_underlying` method that returns a `V`.
+ */
+template <class U, class V, class = void>
+struct Represents : std::false_type {};
+
+template <class U, class V>
+struct Represents<
+    U, V, std::void_t<decltype(std::declval<const U &>().to_underlying())>>
+    : std::is_same<
+          std::decay_t<decltype(std::declval<const U &>().to_underlying())>,
+          V> {};
+
+/**
+ * @brief Adds the default pipeline of braids with `V` factors to a pipeline
+ * of braids with `U` factors.
+ *
+ * Meant for groups' `add_invariants` overloads on the other representations
+ * of their factors (fixed-size, packed, tabulated or interned): braids are
+ * converted to the usual representation before each test.
+ *
+ * @tparam V The usual underlying class.
+ * @tparam U Another representation of `V`.
+ * @param filter The pipeline to add them to.
+ */
+template <class V, class U>
+void add_underlying_invariants(
+    InvariantFilter<BraidTemplate<FactorTemplate<U>>> &filter) {
+    filter.add_converted(
+        default_invariant_filter<BraidTemplate<FactorTemplate<V>>>(),
+        [](const BraidTemplate<FactorTemplate<U>> &b) {
+            return map_factors<FactorTemplate<V>>(
+                b, [](const FactorTemplate<U> &f) {
+                    return FactorTemplate<V>(
+                        f.get_underlying().to_underlying());
+                });
+        });
+}
+
+/**
+ * @brief Cycle type of the permutation a braid induces on its strands.
+ *
+ * Only makes sense for groups whose factors are braids on `n` strands, where
+ * `n` is the parameter, that expose the permutation they induce through an
+ * `at` method on their underlying object (Artin and band braids).
+ *
+ * @tparam F The factor class.
+ * @param b A braid.
+ * @return The lengths of the cycles of the permutation, in increasing order.
+ */
+template <class F>
+std::vector<sint16> permutation_cycle_type(const BraidTemplate<F> &b) {
+    sint16 n = b.get_parameter();
+    std::vector<sint16> p(n + 1), q(n + 1), delta(n + 1);
+    F d(n);
+    d.delta();
+    auto d_under = d.get_underlying();
+
+    for (sint16 i = 1; i <= n; i++) {
+        p[i] = i;
+        delta[i] = d_under.at(i);
+    }
+
+    // The permutation of Delta has small order: the power of it that `b`
+    // starts with is reduced first.
+    sint16 order = 1;
+    for (q = delta; !std::equal(q.begin() + 1, q.end(), p.begin() + 1);
+         order++) {
+        for (sint16 i = 1; i <= n; i++) {
+            q[i] = delta[q[i]];
+        }
+    }
+    sint16 k = ((b.inf() % order) + order) % order;
+
+    for (sint16 _ = 0; _ < k; _++) {
+        for (sint16 i = 1; i <= n; i++) {
+            q[i] = delta[p[i]];
+        }
+        std::swap(p, q);
+    }
+
+    for (typename BraidTemplate<F>::ConstFactorItr it = b.cbegin();
+         it != b.cend(); it++) {
+        auto under = (*it).get_underlying();
+        for (sint16 i = 1; i <= n; i++) {
+            q[i] = under.at(p[i]);
+        }
+        std::swap(p, q);
+    }
+
+    std::vector<sint16> cycles;
+    std::vector<bool> seen(n + 1, false);
+    for (sint16 i = 1; i <= n; i++) {
+        if (!seen[i]) {
+            sint16 l = 0;
+            for (sint16 j = i; !seen[j]; j = p[j]) {
+                seen[j] = true;
+                l++;
+            }
+            cycles.push_back(l);
+        }
+    }
+    std::sort(cycles.begin(), cycles.end());
+    return cycles;
+}
+
+} // namespace garcide
+
+#endif
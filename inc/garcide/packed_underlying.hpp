@@ -0,0 +1,335 @@
+/**
+ * @file packed_underlying.hpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header (and implementation) file for permutation factors packed in a
+ * machine word.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PACKED_UNDERLYING
+#define PACKED_UNDERLYING
+
+#include "garcide/garcide.h"
+#include "garcide/permutation.h"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace garcide {
+
+/**
+ * @brief Permutation factors packed in a 64-bit word.
+ *
+ * `PackedUnderlying<U>` implements the same Garside structure as `U`, which
+ * has to be a permutation based underlying class (`artin::Underlying` or
+ * `band::Underlying`), for at most `MAX_NUMBER_OF_STRANDS` = 16 strands.
+ *
+ * The image of strand `i` is stored, minus one, in the `i`-th nibble of
+ * `word`; nibbles past the number of strands hold fixed points. Equality,
+ * hashing, copies, `is_identity` and `is_delta` thus boil down to word
+ * operations, and products and inverses to nibble shuffles (see
+ * `permutation::compose_nibbles`). A factor takes 16 bytes, so braids and
+ * summit sets built on top of it are several times smaller than with `U`.
+ *
+ * Meets, parsing, printing, atoms and random factors go through `U`.
+ *
+ * @tparam U The underlying class whose factors are packed.
+ */
+template <class U> class PackedUnderlying {
+
+  public:
+    using Parameter = typename U::Parameter;
+
+    /**
+     * @brief Maximum braid index.
+     *
+     * Images have to fit in a nibble.
+     */
+    static const sint16 MAX_NUMBER_OF_STRANDS = 16;
+
+  private:
+    /**
+     * @brief Packed identity permutation.
+     */
+    static const std::uint64_t IDENTITY = 0xFEDCBA9876543210;
+
+    std::uint64_t word;
+
+    std::uint8_t number_of_strands;
+
+    /**
+     * @brief Powers of `U`'s delta, for all numbers of strands.
+     *
+     * `powers[n][k]` is the packed permutation of delta to the `k`, for `k`
+     * smaller than its order.
+     */
+    struct DeltaPowers {
+        std::vector<std::uint64_t> powers[MAX_NUMBER_OF_STRANDS + 1];
+
+        DeltaPowers() {
+            for (sint16 n = 1; n <= MAX_NUMBER_OF_STRANDS; n++) {
+                U d(n);
+                d.delta();
+                std::uint64_t delta = PackedUnderlying(d).word, p = IDENTITY;
+                do {
+                    powers[n].push_back(p);
+                    p = permutation::compose_nibbles(p, delta);
+                } while (p != IDENTITY);
+            }
+        }
+    };
+
+    static const DeltaPowers &delta_powers() {
+        static const DeltaPowers d;
+        return d;
+    }
+
+    PackedUnderlying inverse() const {
+        PackedUnderlying f = *this;
+        f.word = permutation::invert_nibbles(word);
+        return f;
+    }
+
+  public:
+    /**
+     * @brief Checks a number of strands.
+     *
+     * @param n A number of strands.
+     * @exception std::domain_error Thrown when `n` is greater than
+     * `MAX_NUMBER_OF_STRANDS`.
+     * @return `n`.
+     */
+    static Parameter checked(Parameter n) {
+        if (n > MAX_NUMBER_OF_STRANDS) {
+            throw std::domain_error(
+                "Number of strands is too big for packed factors!\n" +
+                std::to_string(n) + " is strictly greater than " +
+                std::to_string(MAX_NUMBER_OF_STRANDS) + ".");
+        }
+        return n;
+    }
+
+    /**
+     * @brief Parses a number of strands.
+     *
+     * Same as `U::parameter_of_string`, except that numbers greater than
+     * `MAX_NUMBER_OF_STRANDS` are rejected.
+     *
+     * @param str The string to parse.
+     * @exception InvalidStringError Thrown when `str` is not a valid
+     * parameter for `U`, or is greater than `MAX_NUMBER_OF_STRANDS`.
+     * @return The number of strands.
+     */
+    static Parameter parameter_of_string(const std::string &str) {
+        Parameter n = U::parameter_of_string(str);
+        if (n > MAX_NUMBER_OF_STRANDS) {
+            throw InvalidStringError(
+                "Number of strands is too big for packed factors!\n" +
+                std::to_string(n) + " is strictly greater than " +
+                std::to_string(MAX_NUMBER_OF_STRANDS) + ".");
+        }
+        return n;
+    }
+
+    Parameter get_parameter() const { return number_of_strands; }
+
+    sint16 at(size_t i) const {
+        return i == 0 ? 0 : sint16((word >> (4 * (i - 1))) & 0xF) + 1;
+    }
+
+    /**
+     * @brief Construct a new `PackedUnderlying`.
+     *
+     * Unlike `U`, it is initialized to the identity.
+     *
+     * @param n The number of strands.
+     * @exception std::domain_error Thrown when `n` is greater than
+     * `MAX_NUMBER_OF_STRANDS`.
+     */
+    PackedUnderlying(Parameter n)
+        : word(IDENTITY), number_of_strands(checked(n)) {}
+
+    /**
+     * @brief Conversion from `U`.
+     *
+     * @param u A factor.
+     * @exception std::domain_error Thrown when `u` has more than
+     * `MAX_NUMBER_OF_STRANDS` strands.
+     */
+    explicit PackedUnderlying(const U &u)
+        : word(IDENTITY), number_of_strands(checked(u.get_parameter())) {
+        for (sint16 i = 1; i <= number_of_strands; i++) {
+            word &= ~(std::uint64_t(0xF) << (4 * (i - 1)));
+            word |= std::uint64_t(u.at(i) - 1) << (4 * (i - 1));
+        }
+    }
+
+    /**
+     * @brief Conversion to `U`.
+     *
+     * @return The same factor, as a `U`.
+     */
+    U to_underlying() const {
+        U u(number_of_strands);
+        for (sint16 i = 1; i <= number_of_strands; i++) {
+            u.permutation_table[i] = at(i);
+        }
+        return u;
+    }
+
+    void of_string(const std::string &str, size_t &pos) {
+        U u(number_of_strands);
+        u.of_string(str, pos);
+        *this = PackedUnderlying(u);
+    }
+
+    sint16 lattice_height() const {
+        return U(number_of_strands).lattice_height();
+    }
+
+    void debug(IndentedOStream &os) const { to_underlying().debug(os); }
+
+    void print(IndentedOStream &os) const { to_underlying().print(os); }
+
+    // Set to the identity element (here the identity).
+    void identity() { word = IDENTITY; }
+
+    // Set to delta.
+    void delta() {
+        const std::vector<std::uint64_t> &powers =
+            delta_powers().powers[number_of_strands];
+        word = powers[1 % powers.size()];
+    }
+
+    PackedUnderlying left_meet(const PackedUnderlying &b) const {
+        return PackedUnderlying(
+            to_underlying().left_meet(b.to_underlying()));
+    }
+
+    PackedUnderlying right_meet(const PackedUnderlying &b) const {
+        return PackedUnderlying(
+            to_underlying().right_meet(b.to_underlying()));
+    }
+
+    // Equality check.
+    // The number of strands is not compared, as for `U`.
+    bool compare(const PackedUnderlying &b) const { return word == b.word; }
+
+    // product under the hypothesis that it is still simple.
+    PackedUnderlying product(const PackedUnderlying &b) const {
+        PackedUnderlying f = *this;
+        f.word = permutation::compose_nibbles(word, b.word);
+        return f;
+    }
+
+    // Under the assumption a <= b, a.left_complement(b) computes
+    // The factor c such that ac = b.
+    PackedUnderlying left_complement(const PackedUnderlying &b) const {
+        return b.product(inverse());
+    }
+
+    PackedUnderlying right_complement(const PackedUnderlying &b) const {
+        return inverse().product(b);
+    }
+
+    // Generate a random factor.
+    void randomize() {
+        U u(number_of_strands);
+        u.randomize();
+        *this = PackedUnderlying(u);
+    }
+
+    // List of atoms.
+    std::vector<PackedUnderlying> atoms() const {
+        std::vector<PackedUnderlying> atoms;
+        for (const U &u : U(number_of_strands).atoms()) {
+            atoms.push_back(PackedUnderlying(u));
+        }
+        return atoms;
+    }
+
+    // Conjugate by delta^k.
+    // This is the permutation of delta^-k, followed by `*this`, followed by
+    // the permutation of delta^k.
+    void delta_conjugate_mut(sint16 k) {
+        const std::vector<std::uint64_t> &powers =
+            delta_powers().powers[number_of_strands];
+        sint16 order = powers.size(), j = Rem(k, order);
+        if (j != 0) {
+            word = permutation::compose_nibbles(
+                permutation::compose_nibbles(powers[order - j], word),
+                powers[j]);
+        }
+    }
+
+    // Factors are ordered by their packed words.
+    int order(const PackedUnderlying &b) const {
+        return word < b.word ? -1 : word > b.word ? 1 : 0;
+    }
+
+    size_t hash() const { return hash_mix(word); }
+};
+
+/**
+ * @brief Converts a braid to a braid with packed factors.
+ *
+ * @tparam U The underlying class of `b`.
+ * @param b The braid to convert.
+ * @exception std::domain_error Thrown when `b` has more than
+ * `PackedUnderlying<U>::MAX_NUMBER_OF_STRANDS` strands.
+ * @return `b`, as a braid with `PackedUnderlying<U>` factors.
+ */
+template <class U>
+BraidTemplate<FactorTemplate<PackedUnderlying<U>>>
+to_packed(const BraidTemplate<FactorTemplate<U>> &b) {
+    PackedUnderlying<U>::checked(b.get_parameter());
+    return map_factors<FactorTemplate<PackedUnderlying<U>>>(
+        b, [](const FactorTemplate<U> &f) {
+            return FactorTemplate<PackedUnderlying<U>>(
+                PackedUnderlying<U>(f.get_underlying()));
+        });
+}
+
+/**
+ * @brief Converts a braid with packed factors back to its usual
+ * representation.
+ *
+ * @tparam U The underlying class of the result.
+ * @param pb The braid to convert.
+ * @return `pb`, as a braid with `U` factors.
+ */
+template <class U>
+BraidTemplate<FactorTemplate<U>>
+of_packed(const BraidTemplate<FactorTemplate<PackedUnderlying<U>>> &pb) {
+    return map_factors<FactorTemplate<U>>(
+        pb, [](const FactorTemplate<PackedUnderlying<U>> &f) {
+            return FactorTemplate<U>(f.get_underlying().to_underlying());
+        });
+}
+
+} // namespace garcide
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * @file permutation.h
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header file for permutation table kernels.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERMUTATION
+#define PERMUTATION
+
+#include "garcide/utility.hpp"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Namespace for operations on permutation tables.
+ *
+ * Permutation tables are arrays `a` such that `a[i]` is the image of `i`, for
+ * `i` in [`0`, `size`). Groups that store their factors as such tables
+ * (`artin`, `band`, `octahedral`, `dual_complex`) use these functions for
+ * products, inverses and complements.
+ *
+ * Composition has vectorized implementations (SSE4.1, AVX2 and AVX-512
+ * shuffles) for small tables. The best one available on the running CPU is
+ * picked the first time a kernel is called; setting environment variable
+ * `GARCIDE_PERMUTATION_KERNELS` to `scalar`, `sse4.1`, `avx2` or `avx512`
+ * caps that choice, which is mostly useful for debugging and benchmarking.
+ *
+ * For 16-bit tables, the SSE4.1 and AVX2 paths load and store whole
+ * registers: `a`, `b` and `r` must be readable (and `r` writable) up to the
+ * next multiple of 16 entries, and whatever lies between `size` and that
+ * bound in `r` may be overwritten. `SmallVector` storage satisfies this.
+ * Tables of `sint16` have no such requirement.
+ */
+namespace garcide::permutation {
+
+/**
+ * @brief Composes two permutation tables.
+ *
+ * Sets `r[i] = b[a[i]]` for `i` in [`0`, `size`), that is, `r` is `a`
+ * followed by `b`. `r` must not alias `a` or `b`.
+ *
+ * @param a First permutation.
+ * @param b Second permutation.
+ * @param r Result.
+ * @param size Number of entries.
+ */
+void compose(const std::uint16_t *a, const std::uint16_t *b, std::uint16_t *r,
+             std::size_t size);
+
+/**
+ * @brief Composes two permutation tables.
+ *
+ * Sets `r[i] = b[a[i]]` for `i` in [`0`, `size`), that is, `r` is `a`
+ * followed by `b`. `r` must not alias `a` or `b`.
+ *
+ * @param a First permutation.
+ * @param b Second permutation.
+ * @param r Result.
+ * @param size Number of entries.
+ */
+void compose(const sint16 *a, const sint16 *b, sint16 *r, std::size_t size);
+
+/**
+ * @brief Inverts a permutation table.
+ *
+ * Sets `r[a[i]] = i` for `i` in [`0`, `size`). `r` must not alias `a`.
+ *
+ * @tparam T Type of the entries.
+ * @param a A permutation.
+ * @param r Result.
+ * @param size Number of entries.
+ */
+template <class T>
+inline void invert(const T *a, T *r, std::size_t size) {
+    for (std::size_t i = 0; i < size; i++) {
+        r[a[i]] = T(i);
+    }
+}
+
+/**
+ * @brief Composes the inverse of a permutation table with another one.
+ *
+ * Sets `r[a[i]] = b[i]` for `i` in [`0`, `size`), that is, `r` is the inverse
+ * of `a` followed by `b`. This is a single pass, where going through
+ * `invert` and then `compose` would take two. `r` must not alias `a` or `b`.
+ *
+ * @tparam T Type of the entries.
+ * @param a First permutation, to be inverted.
+ * @param b Second permutation.
+ * @param r Result.
+ * @param size Number of entries.
+ */
+template <class T>
+inline void invert_then_compose(const T *a, const T *b, T *r,
+                                std::size_t size) {
+    for (std::size_t i = 0; i < size; i++) {
+        r[a[i]] = b[i];
+    }
+}
+
+/**
+ * @brief Composes two permutations packed as nibbles.
+ *
+ * A packed permutation of [`0`, `16`) stores the image of `i` in bits
+ * `4 * i` to `4 * i + 3`. The result is `a` followed by `b`, as for
+ * `compose`.
+ *
+ * @param a First permutation.
+ * @param b Second permutation.
+ * @return The composite permutation.
+ */
+std::uint64_t compose_nibbles(std::uint64_t a, std::uint64_t b);
+
+/**
+ * @brief Inverts a permutation packed as nibbles.
+ *
+ * @param a A packed permutation (see `compose_nibbles`).
+ * @return The inverse of `a`.
+ */
+inline std::uint64_t invert_nibbles(std::uint64_t a) {
+    std::uint64_t r = 0;
+    for (std::uint64_t i = 0; i < 16; i++) {
+        r |= i << (4 * ((a >> (4 * i)) & 0xF));
+    }
+    return r;
+}
+
+/**
+ * @brief Name of the instruction set used by `compose`.
+ *
+ * @return One of `"scalar"`, `"sse4.1"`, `"avx2"` and `"avx512"`.
+ */
+const char *instruction_set();
+
+} // namespace garcide::permutation
+
+#endif
@@ -0,0 +1,463 @@
+/**
+ * @file ring_buffer.hpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header (and implementation) file for a contiguous double-ended queue.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RING_BUFFER
+#define RING_BUFFER
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace garcide {
+
+/**
+ * @brief A double-ended queue stored in a single circular buffer.
+ *
+ * `RingBuffer<T>` supports amortized constant time insertion and removal at
+ * both ends, as well as random access, while keeping all its elements in one
+ * heap block. This makes it a better fit than `std::list` for canonical
+ * factors: normal form computations mostly walk the factors in order, and
+ * copying a braid only costs one allocation.
+ *
+ * The capacity is always zero or a power of two, so that wrapping indexes
+ * around only takes a mask.
+ *
+ * Iterators are invalidated by any insertion, and by removals that do not
+ * happen at the ends.
+ *
+ * @tparam T The type of the elements. It does not need to be default
+ * constructible.
+ */
+template <class T> class RingBuffer {
+
+  public:
+    /**
+     * @brief Random access iterators on `RingBuffer`.
+     *
+     * An iterator stores the position of the element it points to, relative
+     * to the first element of the buffer.
+     *
+     * @tparam IsConst Whether the iterator is a `const_iterator`.
+     */
+    template <bool IsConst> class Iterator {
+
+        friend class RingBuffer;
+
+        template <bool> friend class Iterator;
+
+      public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::conditional<IsConst, const T *, T *>::type;
+        using reference =
+            typename std::conditional<IsConst, const T &, T &>::type;
+
+      private:
+        using Buffer = typename std::conditional<IsConst, const RingBuffer,
+                                                 RingBuffer>::type;
+
+        Buffer *buffer;
+
+        difference_type index;
+
+      public:
+        Iterator() : buffer(nullptr), index(0) {}
+
+        Iterator(Buffer *buffer, difference_type index)
+            : buffer(buffer), index(index) {}
+
+        // Conversion from `iterator` to `const_iterator`.
+        template <bool WasConst,
+                  class = typename std::enable_if<IsConst && !WasConst>::type>
+        Iterator(const Iterator<WasConst> &it)
+            : buffer(it.buffer), index(it.index) {}
+
+        inline reference operator*() const { return (*buffer)[index]; }
+
+        inline pointer operator->() const { return &(*buffer)[index]; }
+
+        inline reference operator[](difference_type n) const {
+            return (*buffer)[index + n];
+        }
+
+        inline Iterator &operator++() {
+            ++index;
+            return *this;
+        }
+
+        inline Iterator operator++(int) {
+            Iterator it = *this;
+            ++index;
+            return it;
+        }
+
+        inline Iterator &operator--() {
+            --index;
+            return *this;
+        }
+
+        inline Iterator operator--(int) {
+            Iterator it = *this;
+            --index;
+            return it;
+        }
+
+        inline Iterator &operator+=(difference_type n) {
+            index += n;
+            return *this;
+        }
+
+        inline Iterator &operator-=(difference_type n) {
+            index -= n;
+            return *this;
+        }
+
+        inline Iterator operator+(difference_type n) const {
+            return Iterator(buffer, index + n);
+        }
+
+        friend inline Iterator operator+(difference_type n,
+                                         const Iterator &it) {
+            return it + n;
+        }
+
+        inline Iterator operator-(difference_type n) const {
+            return Iterator(buffer, index - n);
+        }
+
+        inline difference_type operator-(const Iterator &it) const {
+            return index - it.index;
+        }
+
+        inline bool operator==(const Iterator &it) const {
+            return index == it.index;
+        }
+
+        inline bool operator!=(const Iterator &it) const {
+            return index != it.index;
+        }
+
+        inline bool operator<(const Iterator &it) const {
+            return index < it.index;
+        }
+
+        inline bool operator>(const Iterator &it) const {
+            return index > it.index;
+        }
+
+        inline bool operator<=(const Iterator &it) const {
+            return index <= it.index;
+        }
+
+        inline bool operator>=(const Iterator &it) const {
+            return index >= it.index;
+        }
+    };
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T &;
+    using const_reference = const T &;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  private:
+    /**
+     * @brief The storage.
+     *
+     * Raw storage for `capacity` objects. Only the `length` slots starting
+     * from `head` (wrapping around) hold constructed objects.
+     */
+    T *data;
+
+    /**
+     * @brief Number of slots in `data`.
+     *
+     * Either zero or a power of two.
+     */
+    size_type capacity;
+
+    /**
+     * @brief Slot holding the first element.
+     */
+    size_type head;
+
+    /**
+     * @brief Number of elements.
+     */
+    size_type length;
+
+    std::allocator<T> allocator;
+
+    inline size_type slot(size_type i) const {
+        return (head + i) & (capacity - 1);
+    }
+
+    static size_type capacity_for(size_type n) {
+        size_type c = 1;
+        while (c < n) {
+            c <<= 1;
+        }
+        return c;
+    }
+
+    // Moves the elements to a new buffer with `new_capacity` slots, starting
+    // at slot 0.
+    void reallocate(size_type new_capacity) {
+        T *new_data = allocator.allocate(new_capacity);
+        for (size_type i = 0; i < length; ++i) {
+            T &t = data[slot(i)];
+            ::new (static_cast<void *>(new_data + i)) T(std::move(t));
+            t.~T();
+        }
+        if (data != nullptr) {
+            allocator.deallocate(data, capacity);
+        }
+        data = new_data;
+        capacity = new_capacity;
+        head = 0;
+    }
+
+    inline void grow() {
+        if (length == capacity) {
+            reallocate(capacity == 0 ? 4 : 2 * capacity);
+        }
+    }
+
+  public:
+    RingBuffer() : data(nullptr), capacity(0), head(0), length(0) {}
+
+    RingBuffer(const RingBuffer &b)
+        : data(nullptr), capacity(0), head(0), length(0) {
+        if (b.length != 0) {
+            capacity = capacity_for(b.length);
+            data = allocator.allocate(capacity);
+            for (size_type i = 0; i < b.length; ++i) {
+                ::new (static_cast<void *>(data + i)) T(b[i]);
+                ++length;
+            }
+        }
+    }
+
+    RingBuffer(RingBuffer &&b) noexcept
+        : data(b.data), capacity(b.capacity), head(b.head), length(b.length) {
+        b.data = nullptr;
+        b.capacity = 0;
+        b.head = 0;
+        b.length = 0;
+    }
+
+    ~RingBuffer() {
+        clear();
+        if (data != nullptr) {
+            allocator.deallocate(data, capacity);
+        }
+    }
+
+    RingBuffer &operator=(const RingBuffer &b) {
+        if (this != &b) {
+            clear();
+            if (capacity < b.length) {
+                if (data != nullptr) {
+                    allocator.deallocate(data, capacity);
+                }
+                capacity = capacity_for(b.length);
+                data = allocator.allocate(capacity);
+            }
+            for (size_type i = 0; i < b.length; ++i) {
+                ::new (static_cast<void *>(data + i)) T(b[i]);
+                ++length;
+            }
+        }
+        return *this;
+    }
+
+    RingBuffer &operator=(RingBuffer &&b) noexcept {
+        if (this != &b) {
+            clear();
+            if (data != nullptr) {
+                allocator.deallocate(data, capacity);
+            }
+            data = b.data;
+            capacity = b.capacity;
+            head = b.head;
+            length = b.length;
+            b.data = nullptr;
+            b.capacity = 0;
+            b.head = 0;
+            b.length = 0;
+        }
+        return *this;
+    }
+
+    inline size_type size() const { return length; }
+
+    inline bool empty() const { return length == 0; }
+
+    inline reference operator[](size_type i) { return data[slot(i)]; }
+
+    inline const_reference operator[](size_type i) const {
+        return data[slot(i)];
+    }
+
+    inline reference front() { return data[head]; }
+
+    inline const_reference front() const { return data[head]; }
+
+    inline reference back() { return data[slot(length - 1)]; }
+
+    inline const_reference back() const { return data[slot(length - 1)]; }
+
+    inline iterator begin() { return iterator(this, 0); }
+
+    inline const_iterator begin() const { return const_iterator(this, 0); }
+
+    inline iterator end() { return iterator(this, length); }
+
+    inline const_iterator end() const { return const_iterator(this, length); }
+
+    inline reverse_iterator rbegin() { return reverse_iterator(end()); }
+
+    inline const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+
+    inline reverse_iterator rend() { return reverse_iterator(begin()); }
+
+    inline const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    /**
+     * @brief Reserves storage.
+     *
+     * Makes sure that `n` elements fit without reallocating.
+     *
+     * @param n The number of elements to make room for.
+     */
+    void reserve(size_type n) {
+        if (n > capacity) {
+            reallocate(capacity_for(n));
+        }
+    }
+
+    template <class... Args> inline void emplace_back(Args &&...args) {
+        grow();
+        ::new (static_cast<void *>(data + slot(length)))
+            T(std::forward<Args>(args)...);
+        ++length;
+    }
+
+    template <class... Args> inline void emplace_front(Args &&...args) {
+        grow();
+        size_type h = (head + capacity - 1) & (capacity - 1);
+        ::new (static_cast<void *>(data + h)) T(std::forward<Args>(args)...);
+        head = h;
+        ++length;
+    }
+
+    inline void push_back(const T &t) { emplace_back(t); }
+
+    inline void push_back(T &&t) { emplace_back(std::move(t)); }
+
+    inline void push_front(const T &t) { emplace_front(t); }
+
+    inline void push_front(T &&t) { emplace_front(std::move(t)); }
+
+    inline void pop_back() {
+        --length;
+        data[slot(length)].~T();
+    }
+
+    inline void pop_front() {
+        data[head].~T();
+        head = (head + 1) & (capacity - 1);
+        --length;
+    }
+
+    void clear() {
+        for (size_type i = 0; i < length; ++i) {
+            data[slot(i)].~T();
+        }
+        head = 0;
+        length = 0;
+    }
+
+    /**
+     * @brief Erases a range.
+     *
+     * Erases the elements in `[first, last)`. This takes time linear in the
+     * size of the range when it touches one end of the buffer, and linear in
+     * the number of elements after it otherwise.
+     *
+     * @param first An iterator to the first element to erase.
+     * @param last An iterator past the last element to erase.
+     * @return An iterator to the element that followed the erased range.
+     */
+    iterator erase(const_iterator first, const_iterator last) {
+        difference_type i = first.index, j = last.index;
+        if (i == 0) {
+            for (; j > 0; --j) {
+                pop_front();
+            }
+        } else {
+            for (difference_type k = j; k < difference_type(length); ++k) {
+                (*this)[i + k - j] = std::move((*this)[k]);
+            }
+            for (; j > i; --j) {
+                pop_back();
+            }
+        }
+        return iterator(this, i);
+    }
+
+    bool operator==(const RingBuffer &b) const {
+        if (length != b.length) {
+            return false;
+        }
+        for (size_type i = 0; i < length; ++i) {
+            if (!((*this)[i] == b[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool operator!=(const RingBuffer &b) const { return !(*this == b); }
+};
+
+} // namespace garcide
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * @file shared_table.hpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header (and implementation) file for per-parameter shared tables.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHARED_TABLE
+#define SHARED_TABLE
+
+#include <deque>
+#include <mutex>
+
+namespace garcide {
+
+/**
+ * @brief The `Table` of parameter `p`.
+ *
+ * There is one `Table` per parameter and per `Table` type, shared by all
+ * threads. It is built from `p` on first use, and lives until the program
+ * exits.
+ *
+ * Each thread remembers the last table it asked for, so that in the usual
+ * case where a single parameter is used, no lock is taken.
+ *
+ * @tparam Table A type that can be constructed from a `Parameter`, and
+ * whose `parameter` member is that `Parameter`.
+ * @tparam Parameter The parameter type.
+ * @param p A parameter.
+ * @return The table of `p`.
+ */
+template <class Table, class Parameter>
+const Table *shared_table(const Parameter &p) {
+    thread_local const Table *last = nullptr;
+    if (last != nullptr && last->parameter == p) {
+        return last;
+    }
+    static std::mutex mutex;
+    static std::deque<Table> tables;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Table &t : tables) {
+        if (t.parameter == p) {
+            return last = &t;
+        }
+    }
+    tables.emplace_back(p);
+    return last = &tables.back();
+}
+
+} // namespace garcide
+
+#endif
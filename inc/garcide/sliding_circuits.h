@@ -30,68 +30,61 @@
 #ifndef SLIDING_CIRCUITS
 #define SLIDING_CIRCUITS
 
+#include "garcide/braid_store.hpp"
+#include "garcide/flat_index.hpp"
 #include "garcide/super_summit.h"
+#include <stdexcept>
+#include <tuple>
 
 namespace garcide::sliding_circuits {
 
 template <class F>
 std::vector<BraidTemplate<F>> trajectory(BraidTemplate<F> b) {
     std::vector<BraidTemplate<F>> t;
-    std::unordered_set<BraidTemplate<F>> t_set;
-
-    while (t_set.find(b) == t_set.end()) {
-        t.push_back(b);
-        t_set.insert(b);
-        b.sliding();
-    }
-
+    iterate_until_repetition(
+        std::move(b), [](BraidTemplate<F> &u) { u.sliding(); }, t);
     return t;
 }
 
+// `d` is set to the number of slidings it takes to reach the circuit, and
+// `c` to the conjugator that does so.
 template <class F>
 std::vector<BraidTemplate<F>> trajectory(BraidTemplate<F> b,
                                          BraidTemplate<F> &c, sint16 &d) {
     std::vector<BraidTemplate<F>> t;
-    std::unordered_set<BraidTemplate<F>> t_set;
+    d = sint16(iterate_until_repetition(
+        std::move(b), [](BraidTemplate<F> &u) { u.sliding(); }, t));
 
     c.identity();
-    d = 0;
-
-    while (t_set.find(b) == t_set.end()) {
-        t.push_back(b);
-        t_set.insert(b);
-        c.right_multiply(b.preferred_prefix());
-        b.sliding();
-        d++;
+    for (sint16 i = 0; i < d; i++) {
+        c.right_multiply(t[i].preferred_prefix());
     }
 
-    BraidTemplate<F> b2 = b;
-    BraidTemplate<F> c2 = BraidTemplate(b2.preferred_prefix());
-    b2.sliding();
-    d--;
-    while (b2 != b) {
-        c2.right_multiply(b2.preferred_prefix());
-        b2.sliding();
-        d--;
-    }
-    c.right_divide(c2);
-
     return t;
 }
 
+// The trajectory is not kept (see `find_repetition`), as it may be long.
 template <class F>
 BraidTemplate<F> send_to_sliding_circuits(const BraidTemplate<F> &b) {
-    BraidTemplate<F> b_sc = trajectory(b).back();
-    b_sc.sliding();
+    BraidTemplate<F> b_sc(b.get_parameter());
+    find_repetition(b, [](BraidTemplate<F> &u) { u.sliding(); }, b_sc);
     return b_sc;
 }
 
 template <class F>
 BraidTemplate<F> send_to_sliding_circuits(const BraidTemplate<F> &b,
                                           BraidTemplate<F> &c) {
-    sint16 d;
-    BraidTemplate<F> b_sc = trajectory(b, c, d).back();
-    b_sc.sliding();
+    BraidTemplate<F> b_sc(b.get_parameter());
+    std::size_t mu =
+        find_repetition(b, [](BraidTemplate<F> &u) { u.sliding(); }, b_sc);
+
+    BraidTemplate<F> u = b;
+    c.identity();
+    for (std::size_t i = 0; i < mu; i++) {
+        c.right_multiply(u.preferred_prefix());
+        u.sliding();
+    }
+
     return b_sc;
 }
 
@@ -198,16 +191,27 @@ template <class F> F main_pullback(const BraidTemplate<F> &b, const F &f) {
     return f2;
 }
 
+// Computes in `r` the minimal simple element that left divides `f` and
+// conjugates `b` into its set of sliding circuits, unless it is found along
+// the way to be a left multiple of one of the first `k` elements of `atoms`,
+// in which case `false` is returned (see
+// `super_summit::min_simple_elements`). As the SCS is contained in the SSS,
+// this is already the case if the minimal simple element for the SSS is.
 template <class F>
-F min_sliding_circuits(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
-                       const F &f) {
-    F f2 = super_summit::min_super_summit(b, b_rcf, f);
+bool min_sliding_circuits(const BraidTemplate<F> &b,
+                          const BraidTemplate<F> &b_rcf, const F &f,
+                          const std::vector<F> &atoms, size_t k, F &r) {
+    F f2 = f;
+    if (!super_summit::min_super_summit(b, b_rcf, f, atoms, k, f2)) {
+        return false;
+    }
 
     std::list<F> ret = transports_sending_to_trajectory(b, f2);
     for (typename std::list<F>::iterator it = ret.begin(); it != ret.end();
          it++) {
         if ((f ^ *it) == f) {
-            return *it;
+            r = *it;
+            return !super_summit::is_left_multiple(r, atoms, k);
         }
     }
 
@@ -218,142 +222,123 @@ F min_sliding_circuits(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
     for (typename std::list<F>::iterator it = ret.begin(); it != ret.end();
          it++) {
         if ((f ^ *it) == f) {
-            return *it;
+            r = *it;
+            return !super_summit::is_left_multiple(r, atoms, k);
         }
     }
 
-    f2.delta();
+    r.delta();
 
-    return f2;
+    return !super_summit::is_left_multiple(r, atoms, k);
+}
+
+template <class F>
+F min_sliding_circuits(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
+                       const F &f) {
+    F r = f;
+    min_sliding_circuits(b, b_rcf, f, std::vector<F>(), 0, r);
+    return r;
 }
 
 template <class F>
 std::vector<F> min_sliding_circuits(const BraidTemplate<F> &b,
                                     const BraidTemplate<F> &b_rcf) {
-    F f = F(b.get_parameter());
-    std::vector<F> atoms = f.atoms();
-    std::vector<F> factors = atoms;
-
-#ifndef USE_PAR
-
-    std::transform(
-        atoms.begin(), atoms.end(), factors.begin(),
-        [&b, &b_rcf](F &atom) { return min_sliding_circuits(b, b_rcf, atom); });
-
-#else
-
-    std::transform(
-        std::execution::par, atoms.begin(), atoms.end(), factors.begin(),
-        [&b, &b_rcf](F &atom) { return min_sliding_circuits(b, b_rcf, atom); });
-
-#endif
-
-    std::vector<F> min;
-
-    std::vector<bool> table(atoms.size(), false);
-    bool should_be_added;
-
-    for (sint16 i = 0; i < int(atoms.size()); i++) {
-        f = factors[i];
-        should_be_added = true;
-
-        // We check, before adding f, that a divisor of it wasn't added already
-        // with some other atom dividing it.
-        for (sint16 j = 0; j < i && should_be_added; j++) {
-            should_be_added = !(table[j] && ((atoms[j] ^ f) == atoms[j]));
-        }
-        // If that is not the case, we also check if the atom we see is the last
-        // that might generate f. This is to avoid duplicates; furthermore, if
-        // some strict left divisor of f can be generated by an atom, doing
-        // things in this order ensures that it would have been detected by the
-        // first loop by the time we try to add f.
-        for (sint16 j = i + 1; (j < int(atoms.size())) && should_be_added;
-             j++) {
-            should_be_added = !((atoms[j] ^ f) == atoms[j]);
-        }
-        if (should_be_added) {
-            min.push_back(f);
-            table[i] = true;
-        }
-    }
-
-    return min;
+    return super_summit::min_simple_elements(
+        b, b.preferred_prefix(),
+        [&b, &b_rcf](const F &atom, const std::vector<F> &atoms, size_t k,
+                     F &r) {
+            return min_sliding_circuits(b, b_rcf, atom, atoms, k, r);
+        });
 }
 
-template <class B> struct SCSConstIterator {
-
-  public:
-    using iterator_category = std::forward_iterator_tag;
-    using difference_type = std::ptrdiff_t;
-    using value_type = B;
-    using pointer = typename std::unordered_map<B, int>::const_iterator;
-    using reference = const B &;
+template <class B>
+using SCSConstIterator =
+    typename BraidStore<typename B::Factor>::ConstIterator;
 
+// A SCS is stored as an union of (disjoint) circuits, laid out one after the
+// other in a `BraidStore`, and a `FlatIndex` over that store that is used to
+// speed up membership tests. Up to names, this is exactly the same data
+// structure as `ultra_summit_set::UltraSummitSet`.
+template <class B> class SlidingCircuitsSet {
   private:
-    pointer ptr;
+    using Store = BraidStore<typename B::Factor>;
 
-  public:
-    SCSConstIterator(pointer ptr) : ptr(ptr) {}
+    Store elements;
 
-    reference operator*() const { return std::get<0>(*ptr); }
-    pointer operator->() { return ptr; }
+    // Index in `elements` of the first element of each circuit, followed by
+    // the number of elements.
+    std::vector<size_t> starts;
 
-    // Prefix increment
-    SCSConstIterator &operator++() {
-        ptr++;
-        return *this;
-    }
+    FlatIndex<Store> set;
 
-    // Postfix increment
-    SCSConstIterator operator++(int) {
-        SCSConstIterator tmp = *this;
-        ++(*this);
-        return tmp;
-    }
-
-    bool operator==(const SCSConstIterator &b) const { return ptr == b.ptr; }
-    bool operator!=(const SCSConstIterator &b) const { return ptr != b.ptr; }
-};
-
-// A SCS is stored as both an union of (disjoint) circuits, and a set.
-// The set is actually a map: for each key it stores the circuit it belongs to
-// (as an index referring to circuits). Both are built concurrently; the set
-// part is used to speed up membership tests. Up to names, this is exactly the
-// same data structure as `ultra_summit_set::UltraSummitSet`.
-template <class B> class SlidingCircuitsSet {
   public:
-    std::vector<std::vector<B>> circuits;
-    std::unordered_map<B, sint16> set;
     using ConstIterator = SCSConstIterator<B>;
 
-    inline ConstIterator begin() const { return ConstIterator(set.begin()); }
+    SlidingCircuitsSet() : elements(), starts(1, 0), set() {}
+
+    inline ConstIterator begin() const { return elements.begin(); }
 
-    inline ConstIterator end() const { return ConstIterator(set.end()); }
+    inline ConstIterator end() const { return elements.end(); }
 
     // Adds a trajectory to the SCS.
     // Linear in the trajectory's length.
     inline void insert(std::vector<B> t) {
-        circuits.push_back(t);
-        for (typename std::vector<B>::iterator it = t.begin(); it != t.end();
-             it++) {
-            set.insert(std::pair(*it, int(circuits.size()) - 1));
+        for (const B &b : t) {
+            set.insert(elements.push_back(b), elements);
         }
+        starts.push_back(elements.size());
     }
 
     // Checks membership.
-    inline bool mem(const B &b) const { return set.find(b) != set.end(); }
+    inline bool mem(const B &b) const { return set.mem(b, elements); }
+
+    // Access a braid in the SCS with its circuit and position within it.
+    inline B at(size_t circuit_index, size_t shift) const {
+        return elements.at(starts[circuit_index] + shift);
+    }
 
     // Finds b's circuit.
-    inline sint16 circuit(const B &b) const { return set.at(b); }
+    // Throws `std::out_of_range` if `b` is not in the SCS.
+    inline sint16 circuit(const B &b) const {
+        size_t i;
+        if (!set.find(b, elements, i)) {
+            throw std::out_of_range("Not in the sliding circuits set!");
+        }
+        return std::upper_bound(starts.begin(), starts.end(), i) -
+               starts.begin() - 1;
+    }
+
+    // Finds b's position within its circuit.
+    inline size_t shift(const B &b) const {
+        size_t i = 0;
+        set.find(b, elements, i);
+        return i - starts[circuit(b)];
+    }
+
+    // The smallest element, in the order of `BraidTemplate::order`.
+    // Elements are compared in place, without being rebuilt.
+    B min() const {
+        size_t best = 0;
+        for (size_t i = 1; i < elements.size(); i++) {
+            if (elements.order(i, best) < 0) {
+                best = i;
+            }
+        }
+        return elements.at(best);
+    }
 
-    inline size_t number_of_circuits() const { return circuits.size(); }
+    inline size_t number_of_circuits() const { return starts.size() - 1; }
 
-    inline size_t card() const { return set.size(); }
+    inline size_t card() const { return set.card(); }
+
+    inline size_t circuit_size(size_t circuit_index) const {
+        return starts[circuit_index + 1] - starts[circuit_index];
+    }
 
     inline std::vector<size_t> circuit_sizes() const {
         std::vector<size_t> sizes;
-        for (size_t i = 0; i < circuits.size(); i++) {
-            sizes.push_back(circuits[i].size());
+        for (size_t i = 0; i < number_of_circuits(); i++) {
+            sizes.push_back(circuit_size(i));
         }
         return sizes;
     }
@@ -369,10 +354,10 @@ template <class B> class SlidingCircuitsSet {
             os << "They are split among " << number_of_circuits()
                << " circuits, of respective sizes ";
 
-            for (sint16 i = 0; i < int(circuits.size()); i++) {
+            for (sint16 i = 0; i < int(number_of_circuits()); i++) {
                 os << sizes[i]
-                   << (i == int(circuits.size()) - 1     ? "."
-                       : (i == int(circuits.size()) - 2) ? " and "
+                   << (i == int(number_of_circuits()) - 1     ? "."
+                       : (i == int(number_of_circuits()) - 2) ? " and "
                                                          : ", ");
             }
         } else {
@@ -381,7 +366,7 @@ template <class B> class SlidingCircuitsSet {
 
         os << EndLine(2);
 
-        for (sint16 i = 0; i < int(circuits.size()); i++) {
+        for (sint16 i = 0; i < int(number_of_circuits()); i++) {
             std::string str_i = std::to_string(i);
             for (size_t _ = 0; _ < str_i.length() + 10; _++) {
                 os << "─";
@@ -395,21 +380,21 @@ template <class B> class SlidingCircuitsSet {
                << sizes[i] << " element" << (sizes[i] > 1 ? "s " : " ")
                << "in this circuit." << EndLine(1);
             sint16 indent =
-                (int(std::to_string(circuits[i].size() - 1).length()) + 1) / 4 +
+                (int(std::to_string(circuit_size(i) - 1).length()) + 1) / 4 +
                 1;
-            for (sint16 j = 0; j < int(circuits[i].size()); j++) {
+            for (sint16 j = 0; j < int(circuit_size(i)); j++) {
                 os << j << ":";
                 for (sint16 _ = 0;
                      _ <
                      4 * indent - 1 -
-                         int(std::to_string(circuits[i].size() - 1).length());
+                         int(std::to_string(circuit_size(i) - 1).length());
                      _++) {
                     os << " ";
                 }
                 os.Indent(4 * indent);
-                circuits[i][j].print(os);
+                at(i, j).print(os);
                 os.Indent(-4 * indent);
-                if (j == int(circuits[i].size()) - 1) {
+                if (j == int(circuit_size(i)) - 1) {
                     os.Indent(-4);
                 } else {
                     os << EndLine();
@@ -427,12 +412,12 @@ template <class B> class SlidingCircuitsSet {
         os << EndLine();
         os << "[   ";
         os.Indent(4);
-        for (sint16 i = 0; i < int(circuits.size()); i++) {
+        for (sint16 i = 0; i < int(number_of_circuits()); i++) {
             os << "[   ";
             os.Indent(4);
-            for (sint16 j = 0; j < int(circuits[i].size()); j++) {
-                circuits[i][j].debug(os);
-                if (j == int(circuits[i].size()) - 1) {
+            for (sint16 j = 0; j < int(circuit_size(i)); j++) {
+                at(i, j).debug(os);
+                if (j == int(circuit_size(i)) - 1) {
                     os.Indent(-4);
                 } else {
                     os << ",";
@@ -440,7 +425,7 @@ template <class B> class SlidingCircuitsSet {
                 os << EndLine();
             }
             os << "]";
-            if (i == int(circuits.size()) - 1) {
+            if (i == int(number_of_circuits()) - 1) {
                 os.Indent(-4);
             } else {
                 os << ",";
@@ -456,16 +441,16 @@ template <class B> class SlidingCircuitsSet {
         os << "{   ";
         os.Indent(4);
         bool is_first = true;
-        for (typename std::unordered_map<B, sint16>::const_iterator it =
-                 set.begin();
-             it != set.end(); it++) {
-            if (!is_first) {
-                os << "," << EndLine();
-            } else {
-                is_first = false;
+        for (size_t i = 0; i < number_of_circuits(); i++) {
+            for (size_t j = 0; j < circuit_size(i); j++) {
+                if (!is_first) {
+                    os << "," << EndLine();
+                } else {
+                    is_first = false;
+                }
+                at(i, j).debug(os);
+                os << ": " << i;
             }
-            (*it).first.debug(os);
-            os << ": " << (*it).second;
         }
         os.Indent(-4);
         os << EndLine();
@@ -476,21 +461,58 @@ template <class B> class SlidingCircuitsSet {
     }
 };
 
+// Circuits are explored breadth-first, one level at a time, a circuit being
+// expanded from the element it was found through. For all circuits of a
+// level concurrently, we compute the minimal simple elements of that element,
+// its conjugates by them, and the trajectories of the conjugates that are not
+// in the SCS yet (which is only read during that phase). As conjugating by
+// Delta preserves the SCS, the circuit of each new conjugate's conjugate by
+// Delta is computed along.
+//
+// The new circuits are then claimed sequentially, in the order of the level
+// and of the minimal simple elements, so that circuits are numbered exactly
+// as with a plain FIFO queue, whatever the number of threads.
 template <class F>
 SlidingCircuitsSet<BraidTemplate<F>>
 sliding_circuits_set(const BraidTemplate<F> &b) {
+    // A conjugate found when expanding an element, with the minimal simple
+    // element that gave it and its trajectory, and the same for its
+    // conjugate by Delta. `t_delta` is left empty when `b_delta` is known to
+    // be in the SCS by the time the circuit of `b` is inserted.
+    struct Child {
+        BraidTemplate<F> b;
+        F f;
+        std::vector<BraidTemplate<F>> t;
+        BraidTemplate<F> b_delta;
+        std::vector<BraidTemplate<F>> t_delta;
+    };
+
+    // The element a circuit was found through, with its rcf, which is
+    // computed when it is expanded from its parent's. `parent` is its
+    // parent's index in the previous level (or -1 for the first circuits),
+    // and it was obtained by conjugating with `f`, and then Delta if
+    // `is_delta_conjugate`.
+    struct Element {
+        BraidTemplate<F> b;
+        BraidTemplate<F> b_rcf;
+        sint16 parent;
+        F f;
+        bool is_delta_conjugate;
+        std::vector<Child> children;
+    };
+
+    typename F::Parameter n = b.get_parameter();
     SlidingCircuitsSet<BraidTemplate<F>> scs;
-    std::list<BraidTemplate<F>> queue, queue_rcf;
+    std::vector<Element> level, previous_level;
 
     BraidTemplate<F> b2 = send_to_sliding_circuits(b);
     BraidTemplate<F> b2_rcf = b2;
     b2_rcf.lcf_to_rcf();
 
     scs.insert(trajectory(b2));
-    queue.push_back(b2);
-    queue_rcf.push_back(b2_rcf);
+    level.push_back(Element{b2, b2_rcf, -1, F(n), false, {}});
 
-    F delta = F(b.get_parameter());
+    F delta = F(n);
     delta.delta();
 
     b2.conjugate(delta);
@@ -499,93 +521,258 @@ sliding_circuits_set(const BraidTemplate<F> &b) {
         b2_rcf.conjugate_rcf(delta);
 
         scs.insert(trajectory(b2));
-        queue.push_back(b2);
-        queue_rcf.push_back(b2_rcf);
+        level.push_back(Element{b2, b2_rcf, -1, F(n), false, {}});
     }
 
-    while (!queue.empty()) {
-        std::vector<F> min =
-            min_sliding_circuits(queue.front(), queue_rcf.front());
+    auto expand = [&scs, &previous_level, &delta](Element &e) {
+        if (e.parent >= 0) {
+            e.b_rcf = previous_level[e.parent].b_rcf;
+            e.b_rcf.conjugate_rcf(e.f);
+            if (e.is_delta_conjugate) {
+                e.b_rcf.conjugate_rcf(delta);
+            }
+        }
+
+        std::vector<F> min = min_sliding_circuits(e.b, e.b_rcf);
 
         for (typename std::vector<F>::iterator itf = min.begin();
              itf != min.end(); itf++) {
-            b2 = queue.front();
+            BraidTemplate<F> b3 = e.b;
+            b3.conjugate(*itf);
+
+            if (!scs.mem(b3)) {
+                Child child{b3, *itf, trajectory(b3), b3, {}};
+                child.b_delta.conjugate(delta);
+                if (!scs.mem(child.b_delta) &&
+                    std::find(child.t.begin(), child.t.end(),
+                              child.b_delta) == child.t.end()) {
+                    child.t_delta = trajectory(child.b_delta);
+                }
+                e.children.push_back(std::move(child));
+            }
+        }
+    };
 
-            b2.conjugate(*itf);
+    while (!level.empty()) {
 
-            if (!scs.mem(b2)) {
-                b2_rcf = queue_rcf.front();
-                b2_rcf.conjugate_rcf(*itf);
+#ifndef USE_PAR
 
-                scs.insert(trajectory(b2));
-                queue.push_back(b2);
-                queue_rcf.push_back(b2_rcf);
+        std::for_each(level.begin(), level.end(), expand);
+
+#else
+
+        std::for_each(std::execution::par, level.begin(), level.end(), expand);
+
+#endif
 
-                b2.conjugate(delta);
-                if (!scs.mem(b2)) {
-                    b2_rcf.conjugate_rcf(delta);
+        previous_level.clear();
+        std::swap(level, previous_level);
 
-                    scs.insert(trajectory(b2));
-                    queue.push_back(b2);
-                    queue_rcf.push_back(b2_rcf);
+        // Several conjugates found in the same level may lie in the same
+        // circuit: only the first one claims it.
+        for (sint16 i = 0; i < sint16(previous_level.size()); i++) {
+            for (Child &child : previous_level[i].children) {
+                if (scs.mem(child.b)) {
+                    continue;
+                }
+                scs.insert(std::move(child.t));
+                level.push_back(Element{std::move(child.b),
+                                        BraidTemplate<F>(n), i, child.f,
+                                        false, {}});
+
+                if (!scs.mem(child.b_delta)) {
+                    scs.insert(child.t_delta.empty()
+                                   ? trajectory(child.b_delta)
+                                   : std::move(child.t_delta));
+                    level.push_back(Element{std::move(child.b_delta),
+                                            BraidTemplate<F>(n), i, child.f,
+                                            true, {}});
                 }
             }
+            previous_level[i].children.clear();
         }
-        queue.pop_front();
-        queue_rcf.pop_front();
     }
+
     return scs;
 }
 
-template <class F>
-SlidingCircuitsSet<BraidTemplate<F>>
-sliding_circuits_set(const BraidTemplate<F> &b, std::vector<F> &mins,
-                     std::vector<sint16> &prev) {
+// Same as above, except that conjugates by Delta are not added on their own,
+// and that the BFS tree is recorded: circuit `i` was found by conjugating the
+// element circuit `prev[i]` was found through by `mins[i]`.
+//
+// The search is run one level at a time by `step`, so that two of them may be
+// interleaved (see `are_conjugate`).
+template <class F> class SlidingCircuitsSearch {
+  private:
+    // See `sliding_circuits_set`.
+    struct Element {
+        BraidTemplate<F> b;
+        BraidTemplate<F> b_rcf;
+        sint16 parent;
+        F f;
+        std::vector<std::tuple<BraidTemplate<F>, F,
+                               std::vector<BraidTemplate<F>>>>
+            children;
+    };
+
+    typename F::Parameter n;
+
     SlidingCircuitsSet<BraidTemplate<F>> scs;
-    std::list<BraidTemplate<F>> queue, queue_rcf;
 
-    sint16 current = 0;
-    mins.clear();
-    prev.clear();
-    mins.push_back(F(b.get_parameter()));
-    mins[0].identity();
-    prev.push_back(0);
+    std::vector<F> mins;
 
-    BraidTemplate<F> b2 = send_to_sliding_circuits(b);
-    BraidTemplate<F> b2_rcf = b2;
-    b2_rcf.lcf_to_rcf();
+    std::vector<sint16> prev;
 
-    scs.insert(trajectory(b2));
-    queue.push_back(b2);
-    queue_rcf.push_back(b2_rcf);
+    std::vector<Element> level, previous_level;
 
-    while (!queue.empty()) {
-        std::vector<F> min =
-            min_sliding_circuits(queue.front(), queue_rcf.front());
+    // Index of the first circuit of `previous_level`.
+    sint16 first;
 
-        for (typename std::vector<F>::iterator itf = min.begin();
-             itf != min.end(); itf++) {
-            b2 = queue.front();
-            b2.conjugate(*itf);
+  public:
+    // Starts a search from `b`, which has to be in its SCS.
+    explicit SlidingCircuitsSearch(const BraidTemplate<F> &b)
+        : n(b.get_parameter()), scs(), mins(1, F(b.get_parameter())),
+          prev(1, 0), level(), previous_level(), first(0) {
+        mins[0].identity();
+
+        BraidTemplate<F> b_rcf = b;
+        b_rcf.lcf_to_rcf();
+
+        scs.insert(trajectory(b));
+        level.push_back(Element{b, b_rcf, -1, mins[0], {}});
+    }
+
+    // Whether the whole SCS has been explored.
+    inline bool is_over() const { return level.empty(); }
+
+    // Number of circuits that are to be expanded by the next step.
+    inline size_t frontier_size() const { return level.size(); }
+
+    inline const SlidingCircuitsSet<BraidTemplate<F>> &set() const {
+        return scs;
+    }
+
+    inline const std::vector<F> &get_mins() const { return mins; }
+
+    inline const std::vector<sint16> &get_prev() const { return prev; }
+
+    /**
+     * @brief Explores one more level.
+     *
+     * @param other A SCS that is being explored alongside, or `nullptr`.
+     * @param meet Set to an element of both SCSs, if one is found.
+     * @return Whether a circuit of `other` was found, in which case the step
+     * stops right away, and the search should not go on.
+     */
+    bool step(const SlidingCircuitsSet<BraidTemplate<F>> *other,
+              BraidTemplate<F> &meet) {
+        auto expand = [this](Element &e) {
+            if (e.parent >= 0) {
+                e.b_rcf = previous_level[e.parent].b_rcf;
+                e.b_rcf.conjugate_rcf(e.f);
+            }
+
+            std::vector<F> min = min_sliding_circuits(e.b, e.b_rcf);
+
+            for (typename std::vector<F>::iterator itf = min.begin();
+                 itf != min.end(); itf++) {
+                BraidTemplate<F> b3 = e.b;
+                b3.conjugate(*itf);
+
+                if (!scs.mem(b3)) {
+                    std::vector<BraidTemplate<F>> t = trajectory(b3);
+                    e.children.emplace_back(std::move(b3), *itf,
+                                            std::move(t));
+                }
+            }
+        };
+
+#ifndef USE_PAR
+
+        std::for_each(level.begin(), level.end(), expand);
+
+#else
 
-            if (!scs.mem(b2)) {
-                b2_rcf = queue_rcf.front();
-                b2_rcf.conjugate_rcf(*itf);
+        std::for_each(std::execution::par, level.begin(), level.end(), expand);
 
-                scs.insert(trajectory(b2));
-                queue.push_back(b2);
-                queue_rcf.push_back(b2_rcf);
+#endif
 
-                mins.push_back(*itf);
-                prev.push_back(current);
+        first += previous_level.size();
+        previous_level.clear();
+        std::swap(level, previous_level);
+
+        for (sint16 i = 0; i < sint16(previous_level.size()); i++) {
+            for (auto &child : previous_level[i].children) {
+                if (!scs.mem(std::get<0>(child))) {
+                    scs.insert(std::move(std::get<2>(child)));
+                    mins.push_back(std::get<1>(child));
+                    prev.push_back(first + i);
+                    if (other != nullptr && other->mem(std::get<0>(child))) {
+                        meet = std::get<0>(child);
+                        return true;
+                    }
+                    level.push_back(Element{std::move(std::get<0>(child)),
+                                            BraidTemplate<F>(n), i,
+                                            std::get<1>(child), {}});
+                }
             }
+            previous_level[i].children.clear();
         }
-        queue.pop_front();
-        queue_rcf.pop_front();
 
-        current++;
+        return false;
     }
-    return scs;
+
+    // Explores the rest of the SCS, and moves it (and the tree) out.
+    SlidingCircuitsSet<BraidTemplate<F>>
+    finish(std::vector<F> &tree_mins, std::vector<sint16> &tree_prev) {
+        BraidTemplate<F> meet(n);
+        while (!is_over()) {
+            step(nullptr, meet);
+        }
+        tree_mins = std::move(mins);
+        tree_prev = std::move(prev);
+        return std::move(scs);
+    }
+};
+
+template <class F>
+SlidingCircuitsSet<BraidTemplate<F>>
+sliding_circuits_set(const BraidTemplate<F> &b, std::vector<F> &mins,
+                     std::vector<sint16> &prev) {
+    SlidingCircuitsSearch<F> search(send_to_sliding_circuits(b));
+    return search.finish(mins, prev);
+}
+
+/**
+ * @brief Canonical representative of the conjugacy class of `b`.
+ *
+ * That is, the smallest element of the SCS of `b`, in the order of
+ * `BraidTemplate::order`. Two braids are conjugate if and only if they have
+ * the same canonical representative, so that braids may be sorted or
+ * hashed up to conjugacy in one pass, by sorting or hashing these.
+ *
+ * All elements of the SCS have the same infimum and canonical length, so
+ * that they are told apart by their factors. Comparisons are made in
+ * place, and mostly stop at the first factor.
+ *
+ * The whole SCS is built: the search can not stop early. Circuits are only
+ * reached through other circuits, and nothing relates the order of a
+ * circuit's elements to that of the circuits found from it, so a circuit
+ * whose elements are all greater than the current minimum may still lead
+ * to a smaller one.
+ *
+ * @param b A braid.
+ * @return Its canonical representative.
+ */
+template <class F>
+BraidTemplate<F> canonical_representative(const BraidTemplate<F> &b) {
+    BraidTemplate<F> b2 = send_to_sliding_circuits(b);
+
+    if (b2.canonical_length() == 0) {
+        return b2;
+    }
+
+    return sliding_circuits_set(b2).min();
 }
 
 template <class F>
@@ -600,11 +787,10 @@ BraidTemplate<F> tree_path(const BraidTemplate<F> &b,
     }
 
     sint16 current = scs.circuit(b);
+    size_t shift = scs.shift(b);
 
-    for (typename std::vector<BraidTemplate<F>>::const_iterator itb =
-             scs.circuits[current].begin();
-         *itb != b; itb++) {
-        c.right_multiply((*itb).preferred_prefix());
+    for (size_t i = 0; i < shift; i++) {
+        c.right_multiply(scs.at(current, i).preferred_prefix());
     }
 
     while (current != 0) {
@@ -615,9 +801,63 @@ BraidTemplate<F> tree_path(const BraidTemplate<F> &b,
     return c;
 }
 
+/**
+ * @brief Canonical representative of the conjugacy class of `b`, with a
+ * conjugator.
+ *
+ * @param b A braid.
+ * @param c Set to a braid such that the canonical representative is the
+ * conjugate of `b` by `c`.
+ * @return The canonical representative of `b`.
+ */
+template <class F>
+BraidTemplate<F> canonical_representative(const BraidTemplate<F> &b,
+                                          BraidTemplate<F> &c) {
+    c = BraidTemplate<F>(b.get_parameter());
+    BraidTemplate<F> b2 = send_to_sliding_circuits(b, c);
+
+    if (b2.canonical_length() == 0) {
+        return b2;
+    }
+
+    std::vector<F> mins;
+    std::vector<sint16> prev;
+    SlidingCircuitsSearch<F> search(b2);
+    SlidingCircuitsSet<BraidTemplate<F>> scs = search.finish(mins, prev);
+    BraidTemplate<F> representative = scs.min();
+    c.right_multiply(tree_path(representative, scs, mins, prev));
+    return representative;
+}
+
+/**
+ * @brief Conjugacy test, with a certificate and a prefilter.
+ *
+ * `filter` is run first, and the summit sets are only looked at if it does
+ * not tell `b1` and `b2` apart.
+ *
+ * Both braids are sent to their SCS, which are then explored alongside,
+ * one level at a time (the one with the smaller frontier going first),
+ * until a circuit is found by both searches, or one of them is over (see
+ * `ultra_summit::are_conjugate`).
+ *
+ * @param b1 A braid.
+ * @param b2 A braid.
+ * @param c A braid that is set, when `b1` and `b2` are conjugate, to a
+ * conjugator `c` such that `b2` is the conjugate of `b1` by `c`.
+ * @param filter A pipeline of conjugacy invariants.
+ * @param decided_by Set to what decided the answer: the name of a test of
+ * `filter`, `"summit infimum and supremum"`, or `"sliding circuits set"`.
+ * @return Whether `b1` and `b2` are conjugate.
+ */
 template <class F>
 bool are_conjugate(const BraidTemplate<F> &b1, const BraidTemplate<F> &b2,
-                   BraidTemplate<F> &c) {
+                   BraidTemplate<F> &c,
+                   const InvariantFilter<BraidTemplate<F>> &filter,
+                   std::string &decided_by) {
+    if (!filter.may_be_conjugate(b1, b2, decided_by)) {
+        return false;
+    }
+
     typename F::Parameter n = b1.get_parameter();
     BraidTemplate<F> c1 = BraidTemplate<F>(n), c2 = BraidTemplate<F>(n);
 
@@ -626,29 +866,64 @@ bool are_conjugate(const BraidTemplate<F> &b1, const BraidTemplate<F> &b2,
 
     if (bt1.canonical_length() != bt2.canonical_length() ||
         bt1.sup() != bt2.sup()) {
+        decided_by = "summit infimum and supremum";
         return false;
     }
 
+    decided_by = "sliding circuits set";
+
     if (bt1.canonical_length() == 0) {
         c = c1 * !c2;
         return true;
     }
 
-    std::vector<F> mins;
-    std::vector<sint16> prev;
+    SlidingCircuitsSearch<F> search1(bt1), search2(bt2);
 
-    SlidingCircuitsSet<BraidTemplate<F>> scs =
-        sliding_circuits_set(bt1, mins, prev);
+    // Each search checks the circuits it finds against the other one's, so
+    // that their first circuits have to be checked here.
+    BraidTemplate<F> meet = bt2;
+    bool met = search1.set().mem(bt2);
 
-    if (!scs.mem(bt2)) {
-        return false;
+    while (!met) {
+        if (search1.is_over() || search2.is_over()) {
+            return false;
+        }
+        met = search1.frontier_size() <= search2.frontier_size()
+                  ? search1.step(&search2.set(), meet)
+                  : search2.step(&search1.set(), meet);
     }
 
-    c = c1 * tree_path(bt2, scs, mins, prev) * !c2;
+    c = c1 *
+        tree_path(meet, search1.set(), search1.get_mins(),
+                  search1.get_prev()) *
+        !tree_path(meet, search2.set(), search2.get_mins(),
+                   search2.get_prev()) *
+        !c2;
 
     return true;
 }
 
+/**
+ * @brief Conjugacy test, with a certificate.
+ *
+ * The default pipeline of conjugacy invariants for `BraidTemplate<F>` is
+ * run first (see `default_invariant_filter`).
+ *
+ * @param b1 A braid.
+ * @param b2 A braid.
+ * @param c A braid that is set, when `b1` and `b2` are conjugate, to a
+ * conjugator `c` such that `b2` is the conjugate of `b1` by `c`.
+ * @return Whether `b1` and `b2` are conjugate.
+ */
+template <class F>
+bool are_conjugate(const BraidTemplate<F> &b1, const BraidTemplate<F> &b2,
+                   BraidTemplate<F> &c) {
+    std::string decided_by;
+    return are_conjugate(b1, b2, c,
+                         default_invariant_filter<BraidTemplate<F>>(),
+                         decided_by);
+}
+
 } // namespace garcide::sliding_circuits
 
 #endif
\ No newline at end of file
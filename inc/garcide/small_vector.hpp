@@ -0,0 +1,224 @@
+/**
+ * @file small_vector.hpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header (and implementation) file for fixed-length arrays with inline
+ * storage.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SMALL_VECTOR
+#define SMALL_VECTOR
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace garcide {
+
+/**
+ * @brief Narrowest unsigned type for permutation entries.
+ *
+ * `std::uint8_t` if every value in [`0`, `M`] fits in it, `std::uint16_t`
+ * otherwise. Used to pick the width of permutation tables from the number of
+ * points they act on.
+ *
+ * @tparam M The greatest value that has to be stored.
+ */
+template <std::size_t M>
+using PermutationEntry =
+    typename std::conditional<(M <= 0xFF), std::uint8_t, std::uint16_t>::type;
+
+/**
+ * @brief A fixed-length array that stores short contents inline.
+ *
+ * `SmallVector<T, N>` holds a number of `T` that is set at construction. Up
+ * to `N` elements live inside the object itself, so that building and copying
+ * small factors never touches the heap; longer arrays fall back to a heap
+ * block.
+ *
+ * Inline and heap contents share a union, and the length doubles as the tag
+ * that tells them apart: the object never points into itself, so copying an
+ * inline array is a plain copy of its (trivially copyable) `Storage`.
+ *
+ * Storage is padded to a multiple of `PADDING` elements: vector kernels may
+ * read or clobber the elements between `size()` and `capacity()`.
+ *
+ * @tparam T The type of the elements. Has to be trivially copyable.
+ * @tparam N The inline capacity. Has to be a multiple of `PADDING`.
+ */
+template <class T, std::size_t N> class SmallVector {
+
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SmallVector elements must be trivially copyable.");
+
+  public:
+    /**
+     * @brief Storage granularity, in elements.
+     */
+    static const std::size_t PADDING = 16;
+
+    static_assert(N % PADDING == 0,
+                  "SmallVector inline capacity must be a multiple of PADDING.");
+
+  private:
+    /**
+     * @brief Contents of a `SmallVector`.
+     *
+     * `inline_data` is active when `length <= N`, `heap_data` otherwise.
+     */
+    union Storage {
+        T inline_data[N];
+        T *heap_data;
+    };
+
+    static_assert(std::is_trivially_copyable<Storage>::value,
+                  "Inline SmallVector storage must be trivially copyable.");
+
+    /**
+     * @brief Number of elements.
+     */
+    std::size_t length;
+
+    Storage storage;
+
+    inline bool is_inline() const { return length <= N; }
+
+    inline void allocate() {
+        if (!is_inline()) {
+            storage.heap_data = new T[capacity()];
+        }
+    }
+
+    inline void release() {
+        if (!is_inline()) {
+            delete[] storage.heap_data;
+        }
+    }
+
+  public:
+    /**
+     * @brief Construct a new `SmallVector`.
+     *
+     * Construct a new `SmallVector` holding `n` zeros.
+     *
+     * @param n The number of elements.
+     */
+    explicit SmallVector(std::size_t n) : length(n) {
+        allocate();
+        std::memset(data(), 0, capacity() * sizeof(T));
+    }
+
+    SmallVector(const SmallVector &v) : length(v.length) {
+        if (is_inline()) {
+            storage = v.storage;
+        } else {
+            allocate();
+            std::memcpy(data(), v.data(), capacity() * sizeof(T));
+        }
+    }
+
+    SmallVector(SmallVector &&v) noexcept
+        : length(v.length), storage(v.storage) {
+        if (!is_inline()) {
+            v.length = 0;
+        }
+    }
+
+    ~SmallVector() { release(); }
+
+    SmallVector &operator=(const SmallVector &v) {
+        if (this != &v) {
+            if (v.is_inline()) {
+                release();
+                length = v.length;
+                storage = v.storage;
+            } else {
+                if (length != v.length) {
+                    release();
+                    length = v.length;
+                    allocate();
+                }
+                std::memcpy(data(), v.data(), capacity() * sizeof(T));
+            }
+        }
+        return *this;
+    }
+
+    SmallVector &operator=(SmallVector &&v) noexcept {
+        if (this != &v) {
+            release();
+            length = v.length;
+            storage = v.storage;
+            if (!is_inline()) {
+                v.length = 0;
+            }
+        }
+        return *this;
+    }
+
+    inline std::size_t size() const { return length; }
+
+    /**
+     * @brief Number of allocated elements.
+     *
+     * `size()` rounded up to a multiple of `PADDING`, or `N` for inline
+     * arrays.
+     */
+    inline std::size_t capacity() const {
+        return is_inline() ? N : (length + PADDING - 1) / PADDING * PADDING;
+    }
+
+    inline T *data() {
+        return is_inline() ? storage.inline_data : storage.heap_data;
+    }
+
+    inline const T *data() const {
+        return is_inline() ? storage.inline_data : storage.heap_data;
+    }
+
+    inline T &operator[](std::size_t i) { return data()[i]; }
+
+    inline const T &operator[](std::size_t i) const { return data()[i]; }
+
+    inline T *begin() { return data(); }
+
+    inline const T *begin() const { return data(); }
+
+    inline T *end() { return data() + length; }
+
+    inline const T *end() const { return data() + length; }
+
+    inline bool operator==(const SmallVector &v) const {
+        return length == v.length &&
+               std::memcmp(data(), v.data(), length * sizeof(T)) == 0;
+    }
+
+    inline bool operator!=(const SmallVector &v) const { return !(*this == v); }
+};
+
+} // namespace garcide
+
+#endif
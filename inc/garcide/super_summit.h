@@ -30,9 +30,17 @@
 #ifndef SUPER_SUMMIT
 #define SUPER_SUMMIT
 
+#include "garcide/braid_store.hpp"
+#include "garcide/external_bfs.hpp"
+#include "garcide/flat_index.hpp"
+#include "garcide/invariants.h"
 #include "garcide/garcide.h"
+#include <algorithm>
 #include <cstddef>
 #include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace garcide::super_summit {
 
@@ -97,7 +105,7 @@ BraidTemplate<F> send_to_super_summit(const BraidTemplate<F> &b,
             return b2;
         }
 
-        c2.right_multiply(b2.first().delta_conjugate(b2.inf()));
+        c2.right_multiply(b2.initial());
         b2.cycling();
 
         if (b2.inf() == p) {
@@ -134,8 +142,25 @@ BraidTemplate<F> send_to_super_summit(const BraidTemplate<F> &b,
     return b3;
 }
 
-template <class F> F min_summit(const BraidTemplate<F> &b, const F &f) {
-    F r2 = f, r = F(f.get_parameter());
+// Whether `f` is a left multiple of one of the first `k` elements of `atoms`.
+template <class F>
+bool is_left_multiple(const F &f, const std::vector<F> &atoms, size_t k) {
+    for (size_t i = 0; i < k; i++) {
+        if ((atoms[i] ^ f) == atoms[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Computes in `r` the minimal simple element that left divides `f` and
+// conjugates `b` to a braid with the same infimum, unless it is found along
+// the way to be a left multiple of one of the first `k` elements of `atoms`,
+// in which case `false` is returned (see `min_simple_elements`).
+template <class F>
+bool min_summit(const BraidTemplate<F> &b, const F &f,
+                const std::vector<F> &atoms, size_t k, F &r) {
+    F r2 = f;
     r.identity();
 
     BraidTemplate<F> w = b;
@@ -143,100 +168,251 @@ template <class F> F min_summit(const BraidTemplate<F> &b, const F &f) {
 
     while (!r2.is_identity()) {
         r.right_multiply(r2);
+        if (is_left_multiple(r, atoms, k)) {
+            return false;
+        }
         r2 = (w * r).remainder(r.delta_conjugate(b.inf()));
     }
 
+    return true;
+}
+
+template <class F> F min_summit(const BraidTemplate<F> &b, const F &f) {
+    F r = f;
+    min_summit(b, f, std::vector<F>(), 0, r);
     return r;
 }
 
+// Same as `min_summit`, for the super summit set.
 template <class F>
-F min_super_summit(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
-                   const F &f) {
-    F r = min_summit(b, f);
+bool min_super_summit(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
+                      const F &f, const std::vector<F> &atoms, size_t k,
+                      F &r) {
+    if (!min_summit(b, f, atoms, k, r)) {
+        return false;
+    }
     BraidTemplate<F> b2 = b_rcf;
     b2.conjugate_rcf(r);
 
     while (b2.canonical_length() > b.canonical_length()) {
         r.right_multiply(b2.first());
+        if (is_left_multiple(r, atoms, k)) {
+            return false;
+        }
         b2 = b_rcf;
         b2.conjugate_rcf(r);
     }
-    return r;
+    return true;
 }
 
 template <class F>
-std::vector<F> min_super_summit(const BraidTemplate<F> &b,
-                                const BraidTemplate<F> &b_rcf) {
-    F f = F(b.get_parameter());
-    std::vector<F> atoms = f.atoms();
-    std::vector<F> factors = atoms;
+F min_super_summit(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
+                   const F &f) {
+    F r = f;
+    min_super_summit(b, b_rcf, f, std::vector<F>(), 0, r);
+    return r;
+}
+
+/**
+ * @brief Computes the minimal simple elements conjugating `b` into a summit
+ * set.
+ *
+ * For each atom `a`, there is a minimal simple element `r_a` that `a` left
+ * divides and that conjugates `b` into the summit set. If another atom `c`
+ * left divides `r_a`, then `r_c` left divides `r_a`. The minimal simple
+ * elements are thus among the `r_a`s, and when computing `r_a` we can give up
+ * as soon as the element being built is a left multiple of an atom that was
+ * already processed: `r_a` is then either a duplicate or not minimal.
+ *
+ * Atoms that left divide `hint` are processed first. When `hint` conjugates
+ * `b` into the summit set (e.g., the cycling or sliding conjugator), their
+ * `r_a`s are small, so that other atoms are pruned early. With `USE_PAR`,
+ * atoms are processed in batches of as many as there are hardware threads,
+ * each batch being pruned by the previous ones.
+ *
+ * The result does not depend on that order: minimal elements are listed by
+ * increasing index of the last atom that left divides them.
+ *
+ * @tparam F The factor class.
+ * @tparam Min A class of functions of signature
+ * `bool _(const F &, const std::vector<F> &, size_t, F &)`, that behave as
+ * `min_super_summit` does when given an atom, the processed atoms, their
+ * number and the factor to compute `r_a` in.
+ * @param b A braid in the summit set.
+ * @param hint A simple element whose atoms are processed first.
+ * @param min The function computing `r_a`.
+ * @return The minimal simple elements conjugating `b` into the summit set.
+ */
+template <class F, class Min>
+std::vector<F> min_simple_elements(const BraidTemplate<F> &b, const F &hint,
+                                   Min min) {
+    struct Candidate {
+        F atom;
+        F r;
+        bool is_found;
+    };
+
+    std::vector<F> atoms = F(b.get_parameter()).atoms();
+    std::stable_partition(atoms.begin(), atoms.end(), [&hint](const F &a) {
+        return (a ^ hint) == a;
+    });
+    std::vector<Candidate> candidates;
+    for (const F &a : atoms) {
+        candidates.push_back(Candidate{a, a, false});
+    }
 
 #ifndef USE_PAR
 
-    std::transform(
-        atoms.begin(), atoms.end(), factors.begin(),
-        [&b, &b_rcf](F &atom) { return min_super_summit(b, b_rcf, atom); });
+    size_t batch = 1;
 
 #else
 
-    std::transform(
-        std::execution::par, atoms.begin(), atoms.end(), factors.begin(),
-        [&b, &b_rcf](F &atom) { return min_super_summit(b, b_rcf, atom); });
+    size_t batch = std::max(std::thread::hardware_concurrency(), 1u);
 
 #endif
 
-    std::vector<F> min;
+    for (size_t k = 0; k < atoms.size(); k += batch) {
+        auto compute = [&atoms, &min, k](Candidate &c) {
+            c.is_found = min(c.atom, atoms, k, c.r);
+        };
 
-    std::vector<bool> table(atoms.size(), false);
-    bool should_be_added;
+#ifndef USE_PAR
+
+        std::for_each(candidates.begin() + k,
+                      candidates.begin() + std::min(k + batch, atoms.size()),
+                      compute);
 
-    for (sint16 i = 0; i < int(atoms.size()); i++) {
-        f = factors[i];
-        should_be_added = true;
+#else
 
-        // We check, before adding f, that a divisor of it wasn't added already
-        // with some other atom dividing it.
-        for (sint16 j = 0; j < i && should_be_added; j++) {
-            should_be_added = !(table[j] && ((atoms[j] ^ f) == atoms[j]));
+        std::for_each(std::execution::par, candidates.begin() + k,
+                      candidates.begin() + std::min(k + batch, atoms.size()),
+                      compute);
+
+#endif
+    }
+
+    std::vector<F> found;
+    for (const Candidate &c : candidates) {
+        if (c.is_found) {
+            found.push_back(c.r);
         }
-        // If that is not the case, we also check if the atom we see is the last
-        // that might generate f. This is to avoid duplicates; furthermore, if
-        // some strict left divisor of f can be generated by an atom, doing
-        // things in this order ensures that it would have been detected by the
-        // first loop by the time we try to add f.
-        for (sint16 j = i + 1; j < int(atoms.size()) && should_be_added; j++) {
-            should_be_added = !((atoms[j] ^ f) == atoms[j]);
+    }
+
+    // Every minimal element was found, and each non-minimal one has a
+    // minimal one among `found` that strictly left divides it. Within a
+    // batch, the same element may have been found several times.
+    std::vector<std::pair<sint16, F>> min_elements;
+    std::vector<F> original_atoms = F(b.get_parameter()).atoms();
+    for (size_t i = 0; i < found.size(); i++) {
+        bool is_minimal = true;
+        for (size_t j = 0; j < found.size() && is_minimal; j++) {
+            is_minimal = j == i || (found[j] ^ found[i]) != found[j] ||
+                         (j > i && found[j] == found[i]);
         }
-        if (should_be_added) {
-            min.push_back(f);
-            table[i] = true;
+        if (is_minimal) {
+            sint16 last = int(original_atoms.size()) - 1;
+            while (last > 0 && (original_atoms[last] ^ found[i]) !=
+                                   original_atoms[last]) {
+                last--;
+            }
+            min_elements.emplace_back(last, found[i]);
         }
     }
+    std::sort(min_elements.begin(), min_elements.end(),
+              [](const std::pair<sint16, F> &p, const std::pair<sint16, F> &q) {
+                  return p.first < q.first;
+              });
+
+    std::vector<F> mins;
+    for (const std::pair<sint16, F> &p : min_elements) {
+        mins.push_back(p.second);
+    }
+    return mins;
+}
 
-    return min;
+template <class F>
+std::vector<F> min_super_summit(const BraidTemplate<F> &b,
+                                const BraidTemplate<F> &b_rcf) {
+    return min_simple_elements(
+        b, b.initial(),
+        [&b, &b_rcf](const F &atom, const std::vector<F> &atoms, size_t k,
+                     F &r) {
+            return min_super_summit(b, b_rcf, atom, atoms, k, r);
+        });
 }
 
-// A SuperSummitSet is basically a wrapper for an unordered set.
-// The reason for doing it that way being to have function signatures that are
-// closer to those for USSs and SCSs. This might change later - it could be
-// interesting to instead use a map and save for each element a conjugator.
+template <class B>
+using SSSConstIterator =
+    typename BraidStore<typename B::Factor>::ConstIterator;
+
+// A SSS is stored as a `BraidStore`, in which elements are indexed in the
+// order in which they were inserted, and a `FlatIndex` over that store that
+// is used to speed up membership tests. It also stores, for each index, the
+// index of the element it was found from and the simple element it was
+// conjugated by, so that the SSS is a tree. A conjugator from the first element to any
+// other one is then read along the tree with `tree_path`, in linear time in
+// its depth.
 template <class B> class SuperSummitSet {
   private:
-    std::unordered_set<B> set;
+    using F = typename B::Factor;
 
-  public:
-    using ConstIterator = typename std::unordered_set<B>::const_iterator;
+    BraidStore<F> elements;
+
+    FlatIndex<BraidStore<F>> set;
 
-    inline ConstIterator begin() const { return ConstIterator(set.begin()); }
+    std::vector<sint32> prev;
 
-    inline ConstIterator end() const { return ConstIterator(set.end()); }
+    std::vector<F> mins;
 
-    inline void insert(B b) { set.insert(b); }
+  public:
+    using ConstIterator = SSSConstIterator<B>;
+
+    inline ConstIterator begin() const { return elements.begin(); }
+
+    inline ConstIterator end() const { return elements.end(); }
+
+    /**
+     * @brief Inserts a braid in the SSS.
+     *
+     * Does nothing if `b` is already there.
+     *
+     * @param b The braid to insert.
+     * @param parent Index of the element `b` was found from (unused for the
+     * first element, which is the root of the tree).
+     * @param f A simple element conjugating the element at index `parent` to
+     * `b`.
+     * @return Whether `b` was not already in the SSS.
+     */
+    inline bool insert(const B &b, sint32 parent, const F &f) {
+        if (set.mem(b, elements)) {
+            return false;
+        }
+        set.insert(elements.push_back(b), elements);
+        prev.push_back(prev.empty() ? 0 : parent);
+        mins.push_back(f);
+        return true;
+    }
 
     // Checks membership.
-    inline bool mem(const B &b) const { return set.find(b) != set.end(); }
+    inline bool mem(const B &b) const { return set.mem(b, elements); }
+
+    // Finds b's index.
+    inline sint32 find(const B &b) const {
+        size_t i = 0;
+        set.find(b, elements, i);
+        return i;
+    }
+
+    // Access a braid in the SSS with its index.
+    inline B at(sint32 i) const { return elements.at(i); }
+
+    // Index of the element the element at index `i` was found from.
+    inline sint32 parent(sint32 i) const { return prev[i]; }
 
-    inline sint16 card() const { return set.size(); }
+    // Simple element conjugating `parent(i)` to the element at index `i`.
+    inline const F &min(sint32 i) const { return mins[i]; }
+
+    inline sint32 card() const { return set.card(); }
 
     void print(IndentedOStream &os = ind_cout) const {
         os << "There " << (card() > 1 ? "are " : "is ") << card() << " element"
@@ -294,50 +470,358 @@ template <class B> class SuperSummitSet {
     }
 };
 
-template <class F>
-SuperSummitSet<BraidTemplate<F>> super_summit_set(const BraidTemplate<F> &b) {
-    std::list<BraidTemplate<F>> queue, queue_rcf;
-    SuperSummitSet<BraidTemplate<F>> sss;
+// The super summit set is explored breadth-first, one level at a time.
+// Elements of a level are expanded concurrently, keeping the conjugates that
+// are not in the set yet (which is only read during that phase). These are
+// then merged sequentially, in the order of the level and of the minimal
+// simple elements, so that elements are inserted in the same order as with a
+// plain FIFO queue, whatever the number of threads. Unlike parallelizing
+// `min_super_summit` alone, this keeps cores busy when there are few atoms.
+// The first element is `send_to_super_summit(b)`, and each other one is
+// recorded with the element it was first found from.
+//
+// Visited elements are recorded in `visited`, that is either a
+// `SuperSummitSet` or a `FingerprintVisited`: its `mem` is called
+// concurrently, and its `insert(b, parent, f)` returns whether `b` is new.
+// `discover` is called on each new element, from the calling thread, and
+// returns whether the search should go on. Returns whether the whole set was
+// explored.
+template <class F, class Visited, class Discover>
+bool explore_super_summit(const BraidTemplate<F> &b, Visited &visited,
+                          Discover discover) {
+    // An element of the set, with its rcf, which is computed when it is
+    // expanded from its parent's. `parent` is its parent's index in the
+    // previous level (or -1 for the first element), and `f` the minimal
+    // simple element it was obtained by conjugating with.
+    struct Element {
+        BraidTemplate<F> b;
+        BraidTemplate<F> b_rcf;
+        sint32 parent;
+        F f;
+        std::vector<std::pair<BraidTemplate<F>, F>> children;
+    };
+
+    typename F::Parameter n = b.get_parameter();
+    std::vector<Element> level, previous_level;
+
+    // Index of the first element of `previous_level`.
+    sint32 first = 0;
+    F e(n);
+    e.identity();
 
     BraidTemplate<F> b2 = send_to_super_summit(b);
     BraidTemplate<F> b2_rcf = b2;
     b2_rcf.lcf_to_rcf();
 
-    queue.push_back(b2);
-    queue_rcf.push_back(b2_rcf);
-
-    sss.insert(b2);
+    visited.insert(b2, 0, e);
+    if (!discover(b2)) {
+        return false;
+    }
+    level.push_back(Element{b2, b2_rcf, -1, e, {}});
+
+    // Computes the conjugates of `e` by its minimal simple elements that are
+    // not visited yet.
+    auto expand = [&visited, &previous_level](Element &e) {
+        if (e.parent >= 0) {
+            e.b_rcf = previous_level[e.parent].b_rcf;
+            e.b_rcf.conjugate_rcf(e.f);
+        }
 
-    while (!queue.empty()) {
-        std::vector<F> min = min_super_summit(queue.front(), queue_rcf.front());
+        std::vector<F> min = min_super_summit(e.b, e.b_rcf);
 
         for (typename std::vector<F>::iterator itf = min.begin();
              itf != min.end(); itf++) {
-            b2 = queue.front();
-            b2.conjugate(*itf);
+            BraidTemplate<F> b3 = e.b;
+            b3.conjugate(*itf);
 
-            if (!sss.mem(b2)) {
-                b2_rcf = queue_rcf.front();
-                b2_rcf.conjugate_rcf(*itf);
+            if (!visited.mem(b3)) {
+                e.children.emplace_back(std::move(b3), *itf);
+            }
+        }
+    };
+
+    while (!level.empty()) {
+
+#ifndef USE_PAR
 
-                sss.insert(b2);
-                queue.push_back(b2);
-                queue_rcf.push_back(b2_rcf);
+        std::for_each(level.begin(), level.end(), expand);
+
+#else
+
+        std::for_each(std::execution::par, level.begin(), level.end(), expand);
+
+#endif
+
+        first += previous_level.size();
+        previous_level.clear();
+        std::swap(level, previous_level);
+
+        // The same conjugate may have been found from several elements of
+        // the level: only its first occurrence is kept.
+        for (sint32 i = 0; i < sint32(previous_level.size()); i++) {
+            for (auto &child : previous_level[i].children) {
+                if (visited.insert(child.first, first + i, child.second)) {
+                    if (!discover(child.first)) {
+                        return false;
+                    }
+                    level.push_back(Element{std::move(child.first),
+                                            BraidTemplate<F>(n), i,
+                                            child.second, {}});
+                }
             }
+            previous_level[i].children.clear();
         }
+    }
+
+    return true;
+}
 
-        queue.pop_front();
-        queue_rcf.pop_front();
+template <class F>
+SuperSummitSet<BraidTemplate<F>> super_summit_set(const BraidTemplate<F> &b) {
+    SuperSummitSet<BraidTemplate<F>> sss;
+    explore_super_summit(b, sss, [](const BraidTemplate<F> &) { return true; });
+    return sss;
+}
+
+/**
+ * @brief Visits the super summit set of `b`, without storing it.
+ *
+ * Elements are discovered as in `super_summit_set` (and in the same order),
+ * and `visit` is called on each of them as soon as it is, from the calling
+ * thread. Only the current level of the search and the fingerprints (hashes)
+ * of visited elements are kept in memory, so that the set is not
+ * materialized. Two elements with the same hash are confused (see
+ * `FingerprintSet`).
+ *
+ * @tparam F The factor class.
+ * @tparam Visit A class of functions of signature
+ * `bool _(const BraidTemplate<F> &)`, that return whether the enumeration
+ * should go on.
+ * @param b A braid.
+ * @param visit The function to call on each element.
+ * @return Whether all elements were visited (i.e., `visit` never returned
+ * `false`).
+ */
+template <class F, class Visit>
+bool for_each_super_summit(const BraidTemplate<F> &b, Visit visit) {
+    FingerprintVisited<BraidTemplate<F>> visited;
+    return explore_super_summit(b, visited, visit);
+}
+
+/**
+ * @brief Computes the super summit set of `b` into a file, spilling to disk.
+ *
+ * The set is explored with `external_bfs`, so that memory use is bounded by
+ * `options.memory_budget` rather than by the size of the set. Each element
+ * is written to `path` as a record whose key is its binary encoding (see
+ * `BraidTemplate::to_bytes`), and whose payload is the index of its parent
+ * (see `append_index`) followed by the encoding of the minimal simple
+ * element it was obtained by conjugating with. Elements are in the same
+ * levels as with `super_summit_set`, but sorted by encoding within a level.
+ * The file may be read back with `super_summit_set_of_file`.
+ *
+ * Unlike `super_summit_set`, each element's rcf is computed from scratch
+ * when it is expanded.
+ *
+ * @param b A braid.
+ * @param path The file to write to. It is overwritten.
+ * @param options Where temporary files go, and how much memory to use.
+ * @return The number of elements of the super summit set.
+ */
+template <class F>
+std::size_t super_summit_set_to_file(const BraidTemplate<F> &b,
+                                     const std::string &path,
+                                     const SpillOptions &options) {
+    typename F::Parameter n = b.get_parameter();
+    F e(n);
+    e.identity();
+
+    SpillRecord root;
+    send_to_super_summit(b).to_bytes(root.key);
+    append_index(root.payload, 0);
+    e.to_bytes(root.payload);
+
+    auto expand = [n](const SpillRecord &r, std::size_t index,
+                      std::vector<SpillRecord> &out) {
+        BraidTemplate<F> b2(n);
+        size_t pos = 0;
+        b2.of_bytes(r.key, pos);
+        BraidTemplate<F> b2_rcf = b2;
+        b2_rcf.lcf_to_rcf();
+
+        std::vector<F> min = min_super_summit(b2, b2_rcf);
+
+        for (typename std::vector<F>::iterator itf = min.begin();
+             itf != min.end(); itf++) {
+            BraidTemplate<F> b3 = b2;
+            b3.conjugate(*itf);
+
+            SpillRecord child;
+            b3.to_bytes(child.key);
+            append_index(child.payload, index);
+            (*itf).to_bytes(child.payload);
+            out.push_back(std::move(child));
+        }
+    };
+
+    return external_bfs(root, expand, path, options);
+}
+
+/**
+ * @brief Reads a super summit set written by `super_summit_set_to_file`.
+ *
+ * @param path The file to read from.
+ * @param n The parameter of its elements.
+ * @return The super summit set, with elements in the order of the file.
+ * @exception InvalidStringError Thrown when the file is not as expected.
+ */
+template <class F>
+SuperSummitSet<BraidTemplate<F>>
+super_summit_set_of_file(const std::string &path,
+                         typename F::Parameter n) {
+    SuperSummitSet<BraidTemplate<F>> sss;
+    RecordReader in(path);
+    SpillRecord r;
+    BraidTemplate<F> b(n);
+    F f(n);
+
+    while (in.next(r)) {
+        size_t pos = 0;
+        b.of_bytes(r.key, pos);
+        pos = 0;
+        sint32 parent = read_index(r.payload, pos);
+        f.of_bytes(r.payload, pos);
+        sss.insert(b, parent, f);
     }
 
     return sss;
 }
 
+/**
+ * @brief Computes the super summit set of `b`, spilling to disk while
+ * exploring it.
+ *
+ * Runs `super_summit_set_to_file` on a temporary file in
+ * `options.directory`, and reads the result back. Only the search is bounded
+ * in memory: use `super_summit_set_to_file` when the set itself does not
+ * fit.
+ *
+ * @param b A braid.
+ * @param options Where temporary files go, and how much memory to use.
+ * @return The super summit set of `b`.
+ */
+template <class F>
+SuperSummitSet<BraidTemplate<F>>
+super_summit_set(const BraidTemplate<F> &b, const SpillOptions &options) {
+    SpillDirectory directory(options.directory);
+    std::string path = directory.file();
+    super_summit_set_to_file(b, path, options);
+    return super_summit_set_of_file<F>(path, b.get_parameter());
+}
+
+/**
+ * @brief Computes a conjugator from the first element of a SSS to `b`.
+ *
+ * The minimal simple elements saved along the path from `b` to the root of
+ * the tree are multiplied together, so that this takes linear time in the
+ * depth of `b`.
+ *
+ * @param b An element of `sss`.
+ * @param sss A super summit set, as computed by `super_summit_set`.
+ * @return A braid `c` such that `b` is the conjugate of the first element of
+ * `sss` by `c`.
+ */
+template <class F>
+BraidTemplate<F> tree_path(const BraidTemplate<F> &b,
+                           const SuperSummitSet<BraidTemplate<F>> &sss) {
+    BraidTemplate<F> c = BraidTemplate<F>(b.get_parameter());
+
+    sint32 current = sss.find(b);
+
+    while (current != 0) {
+        c.left_multiply(sss.min(current));
+        current = sss.parent(current);
+    }
+
+    return c;
+}
+
+/**
+ * @brief Conjugacy test, with a certificate and a prefilter.
+ *
+ * `filter` is run first, and the super summit sets are only looked at if it
+ * does not tell `u` and `v` apart.
+ *
+ * @param u A braid.
+ * @param v A braid.
+ * @param c A braid that is set, when `u` and `v` are conjugate, to a
+ * conjugator `c` such that `v` is the conjugate of `u` by `c`.
+ * @param filter A pipeline of conjugacy invariants.
+ * @param decided_by Set to what decided the answer: the name of a test of
+ * `filter`, `"summit infimum and supremum"`, or `"super summit set"`.
+ * @return Whether `u` and `v` are conjugate.
+ */
+template <class F>
+bool are_conjugate(const BraidTemplate<F> &u, const BraidTemplate<F> &v,
+                   BraidTemplate<F> &c,
+                   const InvariantFilter<BraidTemplate<F>> &filter,
+                   std::string &decided_by) {
+    if (!filter.may_be_conjugate(u, v, decided_by)) {
+        return false;
+    }
+
+    typename F::Parameter n = u.get_parameter();
+    BraidTemplate<F> c1 = BraidTemplate<F>(n), c2 = BraidTemplate<F>(n);
+
+    BraidTemplate<F> ut = send_to_super_summit(u, c1),
+                     vt = send_to_super_summit(v, c2);
+
+    if (ut.inf() != vt.inf() || ut.sup() != vt.sup()) {
+        decided_by = "summit infimum and supremum";
+        return false;
+    }
+
+    decided_by = "super summit set";
+
+    // `super_summit_set` sends its argument to the super summit set again,
+    // which does not change an element that is already there.
+    SuperSummitSet<BraidTemplate<F>> u_sss = super_summit_set(ut);
+
+    if (!u_sss.mem(vt)) {
+        return false;
+    }
+
+    c = c1 * tree_path(vt, u_sss) * !c2;
+
+    return true;
+}
+
+/**
+ * @brief Conjugacy test, with a certificate.
+ *
+ * The default pipeline of conjugacy invariants for `BraidTemplate<F>` is
+ * run first (see `default_invariant_filter`).
+ *
+ * @param u A braid.
+ * @param v A braid.
+ * @param c A braid that is set, when `u` and `v` are conjugate, to a
+ * conjugator `c` such that `v` is the conjugate of `u` by `c`.
+ * @return Whether `u` and `v` are conjugate.
+ */
+template <class F>
+bool are_conjugate(const BraidTemplate<F> &u, const BraidTemplate<F> &v,
+                   BraidTemplate<F> &c) {
+    std::string decided_by;
+    return are_conjugate(u, v, c,
+                         default_invariant_filter<BraidTemplate<F>>(),
+                         decided_by);
+}
+
 template <class F>
 inline bool are_conjugate(const BraidTemplate<F> &u,
                           const BraidTemplate<F> &v) {
-    std::unordered_set<BraidTemplate<F>> u_sss = super_summit_set(u);
-    return u_sss.mem(send_to_super_summit(v));
+    BraidTemplate<F> c = BraidTemplate<F>(u.get_parameter());
+    return are_conjugate(u, v, c);
 }
 
 } // namespace garcide::super_summit
@@ -0,0 +1,498 @@
+/**
+ * @file tabulated_underlying.hpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Header (and implementation) file for table-driven factors.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TABULATED_UNDERLYING
+#define TABULATED_UNDERLYING
+
+#include "garcide/garcide.h"
+#include "garcide/shared_table.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace garcide {
+
+/**
+ * @brief Table-driven factors.
+ *
+ * `TabulatedUnderlying<U>` implements the same Garside structure as `U`, for
+ * parameters whose lattice of simple elements is small (at most
+ * `MAX_ELEMENTS` elements, _e.g._ Artin braids on up to 8 strands, or band
+ * braids on up to 10).
+ *
+ * The first time a parameter is used, all its simple elements are
+ * enumerated (as products of atoms, in breadth-first order) and numbered.
+ * A factor is then a pointer to the shared table of its parameter, plus the
+ * number of its simple element, so that comparisons, hashing, copies,
+ * `identity`, `delta` and conjugation by delta are constant time.
+ *
+ * Products, meets and complements are memoized in two-dimensional tables.
+ * These are filled lazily, one block of 64 cells at a time, as the full
+ * tables would have `MAX_ELEMENTS` squared entries: the first time a pair of
+ * elements is met, the operation is carried out by `U`, and from then on it
+ * is a table lookup. Memory thus grows with the pairs that are actually met
+ * (plus a block directory of a few kilobytes per row that is touched).
+ * Filling is lock-free, so tables may be shared between threads.
+ *
+ * Parsing, printing and random factors go through `U`.
+ *
+ * @tparam U The underlying class whose simple elements are tabulated.
+ */
+template <class U> class TabulatedUnderlying {
+
+  public:
+    using Parameter = typename U::Parameter;
+
+    /**
+     * @brief Maximum number of simple elements.
+     *
+     * Parameters with more simple elements than that can not be tabulated.
+     */
+    static const std::uint32_t MAX_ELEMENTS = 1 << 16;
+
+  private:
+    /**
+     * @brief Marks table entries that have not been computed yet.
+     */
+    static const std::uint32_t UNKNOWN = ~std::uint32_t(0);
+
+    /**
+     * @brief Marks products that are not simple elements.
+     */
+    static const std::uint32_t UNDEFINED = UNKNOWN - 1;
+
+    /**
+     * @brief A square table whose cells are allocated and filled on demand.
+     *
+     * Rows are split into blocks of `BLOCK_SIZE` cells. A row only holds a
+     * directory of its blocks, and each block is allocated the first time
+     * one of its cells is looked up, so that memory grows with the set of
+     * pairs that are actually met rather than with whole rows.
+     */
+    class LazyTable {
+        static const std::size_t BLOCK_SIZE = 64;
+
+        using Block = std::atomic<std::uint32_t>;
+
+        using Directory = std::atomic<Block *>;
+
+        std::size_t size;
+
+        std::size_t blocks_per_row;
+
+        std::unique_ptr<std::atomic<Directory *>[]> rows;
+
+        // Publishes `*fresh` in `slot`, unless another thread was faster, in
+        // which case `fresh` is freed. Returns the published pointer.
+        template <class T>
+        static T *publish(std::atomic<T *> &slot, T *fresh) {
+            T *expected = nullptr;
+            if (slot.compare_exchange_strong(expected, fresh,
+                                             std::memory_order_acq_rel)) {
+                return fresh;
+            }
+            delete[] fresh;
+            return expected;
+        }
+
+      public:
+        explicit LazyTable(std::size_t size)
+            : size(size), blocks_per_row((size + BLOCK_SIZE - 1) / BLOCK_SIZE),
+              rows(new std::atomic<Directory *>[size]) {
+            for (std::size_t i = 0; i < size; i++) {
+                rows[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        ~LazyTable() {
+            for (std::size_t i = 0; i < size; i++) {
+                Directory *row = rows[i].load(std::memory_order_relaxed);
+                if (row != nullptr) {
+                    for (std::size_t k = 0; k < blocks_per_row; k++) {
+                        delete[] row[k].load(std::memory_order_relaxed);
+                    }
+                    delete[] row;
+                }
+            }
+        }
+
+        /**
+         * @brief Looks up entry (`i`, `j`).
+         *
+         * @tparam Compute Type of `compute`.
+         * @param i Row.
+         * @param j Column.
+         * @param compute A function computing the entry, called if it is not
+         * known yet.
+         * @return The entry.
+         */
+        template <class Compute>
+        std::uint32_t get(std::uint32_t i, std::uint32_t j,
+                          Compute compute) {
+            Directory *row = rows[i].load(std::memory_order_acquire);
+            if (row == nullptr) {
+                Directory *new_row = new Directory[blocks_per_row];
+                for (std::size_t k = 0; k < blocks_per_row; k++) {
+                    new_row[k].store(nullptr, std::memory_order_relaxed);
+                }
+                row = publish(rows[i], new_row);
+            }
+            Block *block =
+                row[j / BLOCK_SIZE].load(std::memory_order_acquire);
+            if (block == nullptr) {
+                Block *new_block = new Block[BLOCK_SIZE];
+                for (std::size_t k = 0; k < BLOCK_SIZE; k++) {
+                    new_block[k].store(UNKNOWN, std::memory_order_relaxed);
+                }
+                block = publish(row[j / BLOCK_SIZE], new_block);
+            }
+            std::uint32_t e =
+                block[j % BLOCK_SIZE].load(std::memory_order_relaxed);
+            if (e == UNKNOWN) {
+                // Concurrent computations store the same value.
+                e = compute();
+                block[j % BLOCK_SIZE].store(e, std::memory_order_relaxed);
+            }
+            return e;
+        }
+    };
+
+    struct Hash {
+        std::size_t operator()(const U &u) const { return u.hash(); }
+    };
+
+    struct Equal {
+        bool operator()(const U &u, const U &v) const { return u.compare(v); }
+    };
+
+    /**
+     * @brief Everything known about the simple elements of a parameter.
+     */
+    struct Table {
+        Parameter parameter;
+
+        sint16 lattice_height;
+
+        /**
+         * @brief The simple elements, indexed by their numbers.
+         */
+        std::vector<U> elements;
+
+        std::unordered_map<U, std::uint32_t, Hash, Equal> numbers;
+
+        std::uint32_t identity;
+
+        std::uint32_t delta;
+
+        std::vector<std::uint32_t> atoms;
+
+        /**
+         * @brief Conjugates by delta.
+         */
+        std::vector<std::uint32_t> delta_conjugates;
+
+        /**
+         * @brief Order of conjugation by delta.
+         */
+        sint16 delta_conjugation_order;
+
+        mutable LazyTable products, left_meets, right_meets,
+            left_complements, right_complements;
+
+        explicit Table(const Parameter &p)
+            : parameter(p), lattice_height(U(p).lattice_height()),
+              elements(enumerate(p)), products(elements.size()),
+              left_meets(elements.size()), right_meets(elements.size()),
+              left_complements(elements.size()),
+              right_complements(elements.size()) {
+            for (std::uint32_t i = 0; i < elements.size(); i++) {
+                numbers.emplace(elements[i], i);
+            }
+            U u(p);
+            u.identity();
+            identity = number(u);
+            u.delta();
+            delta = number(u);
+            for (const U &a : u.atoms()) {
+                atoms.push_back(number(a));
+            }
+            delta_conjugation_order = 1;
+            std::vector<bool> seen(elements.size(), false);
+            for (const U &e : elements) {
+                u = e;
+                u.delta_conjugate_mut(1);
+                delta_conjugates.push_back(number(u));
+            }
+            for (std::uint32_t i = 0; i < elements.size(); i++) {
+                sint16 length = 0;
+                for (std::uint32_t j = i; !seen[j];
+                     j = delta_conjugates[j]) {
+                    seen[j] = true;
+                    length++;
+                }
+                if (length != 0) {
+                    delta_conjugation_order =
+                        std::lcm(delta_conjugation_order, length);
+                }
+            }
+        }
+
+        // Simple elements are the atoms' products that stay below delta.
+        static std::vector<U> enumerate(const Parameter &p) {
+            U u(p);
+            u.identity();
+            std::vector<U> elements(1, u);
+            std::unordered_map<U, bool, Hash, Equal> seen;
+            seen.emplace(u, true);
+            u.delta();
+            const U delta = u;
+            const std::vector<U> atoms = u.atoms();
+            for (std::size_t i = 0; i < elements.size(); i++) {
+                U complement = elements[i].right_complement(delta);
+                for (const U &a : atoms) {
+                    if (a.left_meet(complement).compare(a)) {
+                        U e = elements[i].product(a);
+                        if (seen.emplace(e, true).second) {
+                            if (elements.size() == MAX_ELEMENTS) {
+                                throw InvalidStringError(
+                                    "Too many simple elements to tabulate!\n"
+                                    "There are more than " +
+                                    std::to_string(MAX_ELEMENTS) + ".");
+                            }
+                            elements.push_back(e);
+                        }
+                    }
+                }
+            }
+            return elements;
+        }
+
+        std::uint32_t number(const U &u) const {
+            auto it = numbers.find(u);
+            return it == numbers.end() ? UNDEFINED : it->second;
+        }
+    };
+
+    /**
+     * @brief The table of parameter `p`.
+     *
+     * Tables are built on first use, and live until the program exits.
+     *
+     * @param p A parameter.
+     * @exception InvalidStringError Thrown when `p` has more than
+     * `MAX_ELEMENTS` simple elements.
+     * @return The table of `p`.
+     */
+    static const Table *table_of(const Parameter &p) {
+        return shared_table<Table>(p);
+    }
+
+    const Table *table;
+
+    std::uint32_t number;
+
+    TabulatedUnderlying(const Table *table, std::uint32_t number)
+        : table(table), number(number) {}
+
+    template <class Operation>
+    TabulatedUnderlying lookup(LazyTable &t, const TabulatedUnderlying &b,
+                               Operation op) const {
+        return TabulatedUnderlying(
+            table, t.get(number, b.number, [&]() {
+                return table->number((to_underlying().*op)(b.to_underlying()));
+            }));
+    }
+
+  public:
+    /**
+     * @brief Parses a parameter.
+     *
+     * Same as `U::parameter_of_string`, except that the parameter's table is
+     * built right away, so that parameters that are too big are rejected.
+     *
+     * @param str The string to parse.
+     * @exception InvalidStringError Thrown when `str` is not a valid
+     * parameter for `U`, or when it has more than `MAX_ELEMENTS` simple
+     * elements.
+     * @return The parameter.
+     */
+    static Parameter parameter_of_string(const std::string &str) {
+        Parameter p = U::parameter_of_string(str);
+        table_of(p);
+        return p;
+    }
+
+    Parameter get_parameter() const { return table->parameter; }
+
+    /**
+     * @brief Construct a new `TabulatedUnderlying`.
+     *
+     * Unlike `U`, it is initialized to the identity.
+     *
+     * @param p The parameter.
+     * @exception InvalidStringError Thrown when `p` has more than
+     * `MAX_ELEMENTS` simple elements.
+     */
+    TabulatedUnderlying(Parameter p)
+        : table(table_of(p)), number(table->identity) {}
+
+    /**
+     * @brief Conversion from `U`.
+     *
+     * @param u A simple element.
+     */
+    explicit TabulatedUnderlying(const U &u)
+        : table(table_of(u.get_parameter())), number(table->number(u)) {}
+
+    /**
+     * @brief Conversion to `U`.
+     *
+     * @return The same factor, as a `U`.
+     */
+    const U &to_underlying() const { return table->elements[number]; }
+
+    void of_string(const std::string &str, size_t &pos) {
+        U u(get_parameter());
+        u.of_string(str, pos);
+        number = table->number(u);
+    }
+
+    sint16 lattice_height() const { return table->lattice_height; }
+
+    void debug(IndentedOStream &os) const { to_underlying().debug(os); }
+
+    void print(IndentedOStream &os) const { to_underlying().print(os); }
+
+    void identity() { number = table->identity; }
+
+    void delta() { number = table->delta; }
+
+    TabulatedUnderlying left_meet(const TabulatedUnderlying &b) const {
+        return lookup(table->left_meets, b,
+                      &U::left_meet);
+    }
+
+    TabulatedUnderlying right_meet(const TabulatedUnderlying &b) const {
+        return lookup(table->right_meets, b,
+                      &U::right_meet);
+    }
+
+    bool compare(const TabulatedUnderlying &b) const {
+        return number == b.number;
+    }
+
+    // product under the hypothesis that it is still simple.
+    TabulatedUnderlying product(const TabulatedUnderlying &b) const {
+        TabulatedUnderlying f =
+            lookup(table->products, b, &U::product);
+        if (f.number == UNDEFINED) {
+            throw std::domain_error("Product is not a simple element!");
+        }
+        return f;
+    }
+
+    TabulatedUnderlying left_complement(const TabulatedUnderlying &b) const {
+        return lookup(table->left_complements, b,
+                      &U::left_complement);
+    }
+
+    TabulatedUnderlying right_complement(const TabulatedUnderlying &b) const {
+        return lookup(table->right_complements, b,
+                      &U::right_complement);
+    }
+
+    void randomize() {
+        U u(get_parameter());
+        u.randomize();
+        number = table->number(u);
+    }
+
+    std::vector<TabulatedUnderlying> atoms() const {
+        std::vector<TabulatedUnderlying> atoms;
+        for (std::uint32_t a : table->atoms) {
+            atoms.push_back(TabulatedUnderlying(table, a));
+        }
+        return atoms;
+    }
+
+    void delta_conjugate_mut(sint16 k) {
+        for (sint16 i = Rem(k, table->delta_conjugation_order); i > 0; i--) {
+            number = table->delta_conjugates[number];
+        }
+    }
+
+    // Factors are ordered by their numbers, which only depend on `U`.
+    int order(const TabulatedUnderlying &b) const {
+        return number < b.number ? -1 : number > b.number ? 1 : 0;
+    }
+
+    size_t hash() const { return hash_mix(number); }
+};
+
+/**
+ * @brief Converts a braid to a braid with tabulated factors.
+ *
+ * @tparam U The underlying class of `b`.
+ * @param b The braid to convert.
+ * @return `b`, as a braid with `TabulatedUnderlying<U>` factors.
+ */
+template <class U>
+BraidTemplate<FactorTemplate<TabulatedUnderlying<U>>>
+to_tabulated(const BraidTemplate<FactorTemplate<U>> &b) {
+    return map_factors<FactorTemplate<TabulatedUnderlying<U>>>(
+        b, [](const FactorTemplate<U> &f) {
+            return FactorTemplate<TabulatedUnderlying<U>>(
+                TabulatedUnderlying<U>(f.get_underlying()));
+        });
+}
+
+/**
+ * @brief Converts a braid with tabulated factors back to its usual
+ * representation.
+ *
+ * @tparam U The underlying class of the result.
+ * @param tb The braid to convert.
+ * @return `tb`, as a braid with `U` factors.
+ */
+template <class U>
+BraidTemplate<FactorTemplate<U>>
+of_tabulated(const BraidTemplate<FactorTemplate<TabulatedUnderlying<U>>> &tb) {
+    return map_factors<FactorTemplate<U>>(
+        tb, [](const FactorTemplate<TabulatedUnderlying<U>> &f) {
+            return FactorTemplate<U>(f.get_underlying().to_underlying());
+        });
+}
+
+} // namespace garcide
+
+#endif
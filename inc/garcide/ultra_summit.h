@@ -30,7 +30,13 @@
 #ifndef ULTRA_SUMMIT
 #define ULTRA_SUMMIT
 
+#include "garcide/braid_store.hpp"
+#include "garcide/class_cache.h"
+#include "garcide/flat_index.hpp"
+#include "garcide/sliding_circuits.h"
 #include "garcide/super_summit.h"
+#include <mutex>
+#include <tuple>
 
 namespace garcide::ultra_summit {
 
@@ -61,14 +67,8 @@ template <class B> struct NotUltraSummit {
 template <class F>
 std::vector<BraidTemplate<F>> trajectory(BraidTemplate<F> b) {
     std::vector<BraidTemplate<F>> t;
-    std::unordered_set<BraidTemplate<F>> t_set;
-
-    while (t_set.find(b) == t_set.end()) {
-        t.push_back(b);
-        t_set.insert(b);
-        b.cycling();
-    }
-
+    iterate_until_repetition(
+        std::move(b), [](BraidTemplate<F> &u) { u.cycling(); }, t);
     return t;
 }
 
@@ -93,18 +93,17 @@ template <class F>
 void trajectory(BraidTemplate<F> b, BraidTemplate<F> b_rcf,
                 std::vector<BraidTemplate<F>> &t,
                 std::vector<BraidTemplate<F>> &t_rcf) {
-    std::unordered_set<BraidTemplate<F>> t_set;
-    t.clear();
     t_rcf.clear();
 
-    while (t_set.find(b) == t_set.end()) {
-        t.push_back(b);
-        t_rcf.push_back(b_rcf);
-        t_set.insert(b);
-        // Cycle in RCF.
-        b_rcf.conjugate_rcf(b.initial());
-        b.cycling();
-    }
+    iterate_until_repetition(
+        std::move(b),
+        [&b_rcf, &t_rcf](BraidTemplate<F> &u) {
+            t_rcf.push_back(b_rcf);
+            // Cycle in RCF.
+            b_rcf.conjugate_rcf(u.initial());
+            u.cycling();
+        },
+        t);
 }
 
 /**
@@ -113,15 +112,18 @@ void trajectory(BraidTemplate<F> b, BraidTemplate<F> b_rcf,
  * Computes an ultra summit conjugate of `b`, by iterated cycling until the
  * first repetition.
  *
+ * The trajectory is not kept (see `find_repetition`), as it may be long.
+ *
  * @tparam F A class representing factors.
  * @param b The braid of whom an ultra summit is computed.
  * @return An ultra summit conjugate of `b`.
  */
 template <class F>
 BraidTemplate<F> send_to_ultra_summit(const BraidTemplate<F> &b) {
-    BraidTemplate<F> b_uss =
-        trajectory(super_summit::send_to_super_summit(b)).back();
-    b_uss.cycling();
+    BraidTemplate<F> b_uss(b.get_parameter());
+    find_repetition(
+        super_summit::send_to_super_summit(b),
+        [](BraidTemplate<F> &u) { u.cycling(); }, b_uss);
     return b_uss;
 }
 
@@ -140,15 +142,15 @@ BraidTemplate<F> send_to_ultra_summit(const BraidTemplate<F> &b) {
 template <class F>
 BraidTemplate<F> send_to_ultra_summit(const BraidTemplate<F> &b,
                                       BraidTemplate<F> &c) {
-    BraidTemplate<F> b_sss = super_summit::send_to_super_summit(b, c);
-    std::vector<BraidTemplate<F>> t = trajectory(b_sss);
-
-    BraidTemplate<F> b_uss = BraidTemplate(t.back());
-    b_uss.cycling();
-
-    for (typename std::vector<BraidTemplate<F>>::iterator it = t.begin();
-         *it != b_uss; it++) {
-        c.right_multiply((*it).first().delta_conjugate(b_sss.inf()));
+    BraidTemplate<F> b_sss = super_summit::send_to_super_summit(b, c),
+                     b_uss(b.get_parameter());
+    std::size_t mu = find_repetition(
+        b_sss, [](BraidTemplate<F> &u) { u.cycling(); }, b_uss);
+
+    BraidTemplate<F> u = b_sss;
+    for (std::size_t i = 0; i < mu; i++) {
+        c.right_multiply(u.initial());
+        u.cycling();
     }
 
     return b_uss;
@@ -162,37 +164,163 @@ BraidTemplate<F> transport(const BraidTemplate<F> &b, const F &f) {
     return b3.first();
 }
 
+/**
+ * @brief Cycling data of an ultra summit braid, shared by the transports
+ * computed from it.
+ *
+ * Transports along the cycling orbit of `b` involve the product of the
+ * conjugators along that orbit, the same products for conjugates of `b` by
+ * simple elements, and the orbit itself in RCF. All of these only depend on
+ * `b`: they are computed once (the latter two as they are needed), and
+ * shared by every atom `min_ultra_summit` looks at, and by `centralizer`.
+ *
+ * Methods may be called concurrently.
+ *
+ * @tparam F The factor class.
+ */
+template <class F> class CyclingCache {
+
+  private:
+    BraidTemplate<F> b, b_rcf;
+
+    bool has_rcf;
+
+    // The cycling orbit of `b`, starting at `b`.
+    std::vector<BraidTemplate<F>> orbit, orbit_rcf;
+
+    // Product of the conjugators along `orbit`.
+    BraidTemplate<F> product;
+
+    std::once_flag rcf_flag;
+
+    // Products of the conjugators along the first `orbit.size()` cyclings of
+    // the conjugates of `b`, by the simple element that conjugates.
+    std::unordered_map<F, BraidTemplate<F>> conjugate_products;
+
+    std::mutex mutex;
+
+    void compute_orbit() {
+        BraidTemplate<F> b1 = b;
+        do {
+            orbit.push_back(b1);
+            product.right_multiply(b1.initial());
+            b1.cycling();
+        } while (b1 != b);
+    }
+
+  public:
+    /**
+     * @brief Constructs the cycling data of `b`.
+     *
+     * @param b A braid in its USS.
+     */
+    explicit CyclingCache(const BraidTemplate<F> &b)
+        : b(b), b_rcf(b), has_rcf(false), orbit(), orbit_rcf(),
+          product(b.get_parameter()), rcf_flag(), conjugate_products(),
+          mutex() {
+        compute_orbit();
+    }
+
+    /**
+     * @brief Constructs the cycling data of `b`.
+     *
+     * @param b A braid in its USS.
+     * @param b_rcf `b`, in RCF.
+     */
+    CyclingCache(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf)
+        : b(b), b_rcf(b_rcf), has_rcf(true), orbit(), orbit_rcf(),
+          product(b.get_parameter()), rcf_flag(), conjugate_products(),
+          mutex() {
+        compute_orbit();
+    }
+
+    inline const BraidTemplate<F> &get_braid() const { return b; }
+
+    // Forces the RCF, if it was not given.
+    const BraidTemplate<F> &get_braid_rcf() { return get_orbit_rcf()[0]; }
+
+    inline size_t orbit_length() const { return orbit.size(); }
+
+    inline const std::vector<BraidTemplate<F>> &get_orbit() const {
+        return orbit;
+    }
+
+    /**
+     * @brief The cycling orbit of `b`, in RCF.
+     *
+     * It is computed the first time it is asked for.
+     *
+     * @return A reference to it.
+     */
+    const std::vector<BraidTemplate<F>> &get_orbit_rcf() {
+        std::call_once(rcf_flag, [this]() {
+            BraidTemplate<F> b1_rcf = b_rcf;
+            if (!has_rcf) {
+                b1_rcf.lcf_to_rcf();
+            }
+            for (const BraidTemplate<F> &b1 : orbit) {
+                orbit_rcf.push_back(b1_rcf);
+                b1_rcf.conjugate_rcf(b1.initial());
+            }
+        });
+        return orbit_rcf;
+    }
+
+    /**
+     * @brief The product of the conjugators along the cycling orbit of `b`.
+     *
+     * @return A reference to it.
+     */
+    inline const BraidTemplate<F> &orbit_product() const { return product; }
+
+    /**
+     * @brief The product of the conjugators along the first cyclings of a
+     * conjugate of `b`.
+     *
+     * There are as many of these as elements in the cycling orbit of `b`.
+     * Products are remembered, so that each one is only computed once (but
+     * for concurrent calls).
+     *
+     * @param f A simple element.
+     * @return The product, for the conjugate of `b` by `f`.
+     */
+    BraidTemplate<F> conjugate_product(const F &f) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            typename std::unordered_map<F, BraidTemplate<F>>::const_iterator
+                it = conjugate_products.find(f);
+            if (it != conjugate_products.end()) {
+                return it->second;
+            }
+        }
+
+        BraidTemplate<F> b1 = b, c2 = BraidTemplate<F>(b.get_parameter());
+        b1.conjugate(f);
+        for (size_t i = 0; i < orbit.size(); i++) {
+            c2.right_multiply(b1.initial());
+            b1.cycling();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        conjugate_products.emplace(f, c2);
+        return c2;
+    }
+};
+
 template <class F>
-std::list<F> transports_sending_to_trajectory(const BraidTemplate<F> &b,
+std::list<F> transports_sending_to_trajectory(CyclingCache<F> &cache,
                                               const F &f) {
     std::list<F> ret;
     std::unordered_set<F> ret_set;
-    BraidTemplate<F> b1 = BraidTemplate(b),
-                     c2 = BraidTemplate<F>(b.get_parameter());
-    sint16 i, n = 1;
     F f1 = f;
 
-    BraidTemplate<F> c1 = BraidTemplate(b1.first().delta_conjugate(b1.inf()));
-    b1.cycling();
-
-    while (b1 != b) {
-        c1.right_multiply(BraidTemplate(b1.first().delta_conjugate(b1.inf())));
-        b1.cycling();
-        n++;
-    }
+    const BraidTemplate<F> &c1 = cache.orbit_product();
 
     while (ret_set.find(f1) == ret_set.end()) {
         ret.push_back(f1);
         ret_set.insert(f1);
-        b1 = b;
-        b1.conjugate(f1);
-        c2.identity();
-        for (i = 0; i < n; i++) {
-            c2.right_multiply(b1.first().delta_conjugate(b1.inf()));
-            b1.cycling();
-        }
 
-        BraidTemplate<F> b2 = (!c1) * f1 * c2;
+        BraidTemplate<F> b2 = (!c1) * f1 * cache.conjugate_product(f1);
 
         if (b2.inf() == 1) {
             f1.delta();
@@ -210,11 +338,18 @@ std::list<F> transports_sending_to_trajectory(const BraidTemplate<F> &b,
     return ret;
 }
 
+template <class F>
+std::list<F> transports_sending_to_trajectory(const BraidTemplate<F> &b,
+                                              const F &f) {
+    CyclingCache<F> cache(b);
+    return transports_sending_to_trajectory(cache, f);
+}
+
 template <class F>
 F pullback(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
            const F &f) {
-    F f1 = b.first().delta_conjugate(b.inf() + 1);
-    F f2 = f.delta_conjugate();
+    F f1 = b.first().delta_conjugate(-b.inf() - 1);
+    F f2 = f.delta_conjugate(-1);
 
     BraidTemplate<F> b2 = BraidTemplate(f1) * f2;
 
@@ -245,17 +380,12 @@ F pullback(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
     return super_summit::min_super_summit(b, b_rcf, f0.left_join(fi));
 }
 
-template <class F>
-F main_pullback(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
-                const F &f) {
+template <class F> F main_pullback(CyclingCache<F> &cache, const F &f) {
     std::vector<F> ret;
     std::unordered_map<F, sint16> ret_set;
 
-    BraidTemplate<F> b2 = BraidTemplate(b);
-
-    std::vector<BraidTemplate<F>> t, t_rcf;
-
-    trajectory(b, b_rcf, t, t_rcf);
+    const std::vector<BraidTemplate<F>> &t = cache.get_orbit(),
+                                        &t_rcf = cache.get_orbit_rcf();
 
     F f2 = f;
     sint16 index = 0;
@@ -279,27 +409,47 @@ F main_pullback(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
 }
 
 template <class F>
-F min_ultra_summit(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
-                   const F &f) {
-    F f2 = super_summit::min_super_summit(b, b_rcf, f);
+F main_pullback(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
+                const F &f) {
+    CyclingCache<F> cache(b, b_rcf);
+    return main_pullback(cache, f);
+}
+
+// Computes in `r` the minimal simple element that left divides `f` and
+// conjugates `b` into its ultra summit set, unless it is found along the way
+// to be a left multiple of one of the first `k` elements of `atoms`, in which
+// case `false` is returned (see `super_summit::min_simple_elements`). As the
+// USS is contained in the SSS, this is already the case if the minimal simple
+// element for the SSS is.
+template <class F>
+bool min_ultra_summit(CyclingCache<F> &cache, const F &f,
+                      const std::vector<F> &atoms, size_t k, F &r) {
+    const BraidTemplate<F> &b = cache.get_braid();
+    F f2 = f;
+    if (!super_summit::min_super_summit(b, cache.get_braid_rcf(), f, atoms, k,
+                                        f2)) {
+        return false;
+    }
 
-    std::list<F> ret = transports_sending_to_trajectory(b, f2);
+    std::list<F> ret = transports_sending_to_trajectory(cache, f2);
 
-    typename BraidTemplate<F>::FactorItr it;
+    typename std::list<F>::iterator it;
 
     for (it = ret.begin(); it != ret.end(); it++) {
         if ((f ^ *it) == f) {
-            return *it;
+            r = *it;
+            return !super_summit::is_left_multiple(r, atoms, k);
         }
     }
 
-    f2 = main_pullback(b, b_rcf, f);
+    f2 = main_pullback(cache, f);
 
-    ret = transports_sending_to_trajectory(b, f2);
+    ret = transports_sending_to_trajectory(cache, f2);
 
     for (it = ret.begin(); it != ret.end(); it++) {
         if ((f ^ *it) == f) {
-            return *it;
+            r = *it;
+            return !super_summit::is_left_multiple(r, atoms, k);
         }
     }
 
@@ -307,120 +457,85 @@ F min_ultra_summit(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
 }
 
 template <class F>
-std::vector<F> min_ultra_summit(const BraidTemplate<F> &b,
-                                const BraidTemplate<F> &b_rcf) {
-    F f = F(b.get_parameter());
-    std::vector<F> atoms = f.atoms();
-    std::vector<F> factors = atoms;
-
-#ifndef USE_PAR
-
-    std::transform(
-        atoms.begin(), atoms.end(), factors.begin(),
-        [&b, &b_rcf](F &atom) { return min_ultra_summit(b, b_rcf, atom); });
-
-#else
-
-    std::transform(
-        std::execution::par, atoms.begin(), atoms.end(), factors.begin(),
-        [&b, &b_rcf](F &atom) { return min_ultra_summit(b, b_rcf, atom); });
-
-#endif
-
-    std::vector<F> min;
-
-    std::vector<bool> table(atoms.size(), false);
-    bool should_be_added;
-
-    for (sint16 i = 0; i < int(atoms.size()); i++) {
-        f = factors[i];
-        should_be_added = true;
+bool min_ultra_summit(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
+                      const F &f, const std::vector<F> &atoms, size_t k,
+                      F &r) {
+    CyclingCache<F> cache(b, b_rcf);
+    return min_ultra_summit(cache, f, atoms, k, r);
+}
 
-        // We check, before adding f, that a divisor of it wasn't added already
-        // with some other atom dividing it.
-        for (sint16 j = 0; (j < i) && should_be_added; j++) {
-            should_be_added = !(table[j] && ((atoms[j] ^ f) == atoms[j]));
-        }
-        // If that is not the case, we also check if the atom we see is the last
-        // that might generate f. This is to avoid duplicates; furthermore, if
-        // some strict left divisor of f can be generated by an atom, doing
-        // things in this order ensures that it would have been detected by the
-        // first loop by the time we try to add f.
-        for (sint16 j = i + 1; (j < int(atoms.size())) && should_be_added;
-             j++) {
-            should_be_added = !((atoms[j] ^ f) == atoms[j]);
-        }
-        if (should_be_added) {
-            min.push_back(f);
-            table[i] = true;
-        }
-    }
+template <class F>
+F min_ultra_summit(const BraidTemplate<F> &b, const BraidTemplate<F> &b_rcf,
+                   const F &f) {
+    F r = f;
+    min_ultra_summit(b, b_rcf, f, std::vector<F>(), 0, r);
+    return r;
+}
 
-    return min;
+// The cycling data of `b` is shared by all atoms (see `CyclingCache`).
+template <class F> std::vector<F> min_ultra_summit(CyclingCache<F> &cache) {
+    const BraidTemplate<F> &b = cache.get_braid();
+    return super_summit::min_simple_elements(
+        b, b.initial(),
+        [&cache](const F &atom, const std::vector<F> &atoms, size_t k, F &r) {
+            return min_ultra_summit(cache, atom, atoms, k, r);
+        });
 }
 
-template <class B> struct USSConstIterator {
+template <class F>
+std::vector<F> min_ultra_summit(const BraidTemplate<F> &b,
+                                const BraidTemplate<F> &b_rcf) {
+    CyclingCache<F> cache(b, b_rcf);
+    return min_ultra_summit(cache);
+}
 
-  public:
-    using iterator_category = std::forward_iterator_tag;
-    using difference_type = std::ptrdiff_t;
-    using value_type = B;
-    using pointer = typename std::unordered_map<B, int>::const_iterator;
-    using reference = const B &;
+template <class B>
+using USSConstIterator =
+    typename BraidStore<typename B::Factor>::ConstIterator;
 
+// An USS is stored as an union of (disjoint) trajectories, laid out one after
+// the other in a `BraidStore`, so that each element is stored only once and
+// its factors live in an arena. Membership tests go through a `FlatIndex`
+// over the store. Elements are iterated over orbit by orbit.
+template <class B> class UltraSummitSet {
   private:
-    pointer ptr;
+    using Store = BraidStore<typename B::Factor>;
 
-  public:
-    USSConstIterator(pointer ptr) : ptr(ptr) {}
+    Store elements;
 
-    reference operator*() const { return std::get<0>(*ptr); }
-    pointer operator->() { return ptr; }
+    // Index in `elements` of the first element of each orbit, followed by
+    // the number of elements.
+    std::vector<size_t> starts;
 
-    // Prefix increment
-    USSConstIterator &operator++() {
-        ptr++;
-        return *this;
-    }
+    FlatIndex<Store> set;
 
-    // Postfix increment
-    USSConstIterator operator++(int) {
-        USSConstIterator tmp = *this;
-        ++(*this);
-        return tmp;
+    // Index in `elements` of `b`, which has to be in the USS.
+    inline size_t index(const B &b) const {
+        size_t i = 0;
+        set.find(b, elements, i);
+        return i;
     }
 
-    bool operator==(const USSConstIterator &b) const { return ptr == b.ptr; }
-    bool operator!=(const USSConstIterator &b) const { return ptr != b.ptr; }
-};
-
-// An USS is stored as, on one side, an union of (disjoint) trajectories, and on
-// the other side a set. The set is actually a map: for each key it stores the
-// orbit it belongs to (as an index referring to orbits). Both are built
-// concurrently; the set part is used to speed up membership tests.
-template <class B> class UltraSummitSet {
   public:
-    std::vector<std::vector<B>> orbits;
-    std::unordered_map<B, sint16> set;
-
     using ConstIterator = USSConstIterator<B>;
 
-    inline ConstIterator begin() const { return ConstIterator(set.begin()); }
+    UltraSummitSet() : elements(), starts(1, 0), set() {}
 
-    inline ConstIterator end() const { return ConstIterator(set.end()); }
+    inline ConstIterator begin() const { return elements.begin(); }
+
+    inline ConstIterator end() const { return elements.end(); }
 
     // Adds a trajectory to the USS.
     // Linear in the trajectory's length.
     inline void insert(std::vector<B> t) {
-        orbits.push_back(t);
-        for (typename std::vector<B>::iterator it = t.begin(); it != t.end();
-             it++) {
-            set.insert(std::pair(*it, int(orbits.size()) - 1));
+        for (const B &b : t) {
+            set.insert(elements.push_back(b), elements);
         }
+        starts.push_back(elements.size());
     }
 
     // Checks membership.
-    inline bool mem(const B &b) const { return set.find(b) != set.end(); }
+    inline bool mem(const B &b) const { return set.mem(b, elements); }
 
     /**
      * @brief Access a braid in the USS with its position.
@@ -430,7 +545,7 @@ template <class B> class UltraSummitSet {
      * @return B
      */
     inline B at(size_t orbit_index, size_t shift) const {
-        return orbits[orbit_index][shift];
+        return elements.at(starts[orbit_index] + shift);
     }
 
     /**
@@ -441,24 +556,30 @@ template <class B> class UltraSummitSet {
      * @return B
      */
     inline B at(sint16 orbit_index, sint16 shift) const {
-        return orbits[orbit_index][shift];
+        return elements.at(starts[orbit_index] + shift);
     }
 
     // Finds b's orbit.
     inline sint16 find_orbit(const B &b) const {
-        return std::get<1>(*set.find(b));
+        return std::upper_bound(starts.begin(), starts.end(), index(b)) -
+               starts.begin() - 1;
     }
 
-    inline size_t number_of_orbits() const { return orbits.size(); }
+    // Finds b's position within its orbit.
+    inline size_t find_shift(const B &b) const {
+        return index(b) - starts[find_orbit(b)];
+    }
 
-    inline size_t card() const { return set.size(); }
+    inline size_t number_of_orbits() const { return starts.size() - 1; }
+
+    inline size_t card() const { return set.card(); }
 
     inline size_t orbit_size(size_t orbit_index) const {
-        return orbits[orbit_index].size();
+        return starts[orbit_index + 1] - starts[orbit_index];
     }
 
     inline size_t orbit_size(sint16 orbit_index) const {
-        return orbits[orbit_index].size();
+        return starts[orbit_index + 1] - starts[orbit_index];
     }
 
     void print(IndentedOStream &os = ind_cout) const {
@@ -537,7 +658,7 @@ template <class B> class UltraSummitSet {
         for (size_t i = 0; i < number_of_orbits(); i++) {
             os << "[   ";
             os.Indent(4);
-            for (size_t j = 0; j < number_of_orbits(); j++) {
+            for (size_t j = 0; j < orbit_size(i); j++) {
                 at(i, j).debug(os);
                 if (j == orbit_size(i) - 1) {
                     os.Indent(-4);
@@ -563,16 +684,16 @@ template <class B> class UltraSummitSet {
         os << "{   ";
         os.Indent(4);
         bool is_first = true;
-        for (typename std::unordered_map<B, sint16>::const_iterator it =
-                 set.begin();
-             it != set.end(); it++) {
-            if (!is_first) {
-                os << "," << EndLine();
-            } else {
-                is_first = false;
+        for (size_t i = 0; i < number_of_orbits(); i++) {
+            for (size_t j = 0; j < orbit_size(i); j++) {
+                if (!is_first) {
+                    os << "," << EndLine();
+                } else {
+                    is_first = false;
+                }
+                at(i, j).debug(os);
+                os << ": " << i;
             }
-            (*it).first.debug(os);
-            os << ": " << (*it).second;
         }
         os.Indent(-4);
         os << EndLine();
@@ -584,91 +705,472 @@ template <class B> class UltraSummitSet {
 };
 
 template <class F>
-UltraSummitSet<BraidTemplate<F>> ultra_summit_set(const BraidTemplate<F> &b) {
+UltraSummitSet<BraidTemplate<F>> ultra_summit_set(const BraidTemplate<F> &b,
+                                                  std::vector<F> &mins,
+                                                  std::vector<sint16> &prev);
+
+// Appends the orbits of `uss` to `bytes`: their number, and then, for each
+// of them, its size followed by its elements.
+template <class F>
+void ultra_summit_set_to_bytes(const UltraSummitSet<BraidTemplate<F>> &uss,
+                               std::string &bytes) {
+    append_varint(bytes, uss.number_of_orbits());
+    for (size_t i = 0; i < uss.number_of_orbits(); i++) {
+        append_varint(bytes, uss.orbit_size(i));
+        for (size_t j = 0; j < uss.orbit_size(i); j++) {
+            uss.at(i, j).to_bytes(bytes);
+        }
+    }
+}
+
+// Reads what `ultra_summit_set_to_bytes` wrote. The orbit of `b` (if it is
+// there) is put first, starting at `b`, as if the USS was computed from it.
+template <class F>
+UltraSummitSet<BraidTemplate<F>>
+ultra_summit_set_of_bytes(const std::string &bytes, const BraidTemplate<F> &b) {
+    size_t pos = 0;
+    std::vector<std::vector<BraidTemplate<F>>> orbits(
+        read_varint(bytes, pos));
+    BraidTemplate<F> u(b.get_parameter());
+    for (std::vector<BraidTemplate<F>> &orbit : orbits) {
+        size_t size = read_varint(bytes, pos);
+        orbit.reserve(size);
+        for (size_t j = 0; j < size; j++) {
+            u.of_bytes(bytes, pos);
+            orbit.push_back(u);
+        }
+    }
+
+    for (size_t i = 0; i < orbits.size(); i++) {
+        typename std::vector<BraidTemplate<F>>::iterator it =
+            std::find(orbits[i].begin(), orbits[i].end(), b);
+        if (it != orbits[i].end()) {
+            std::rotate(orbits[i].begin(), it, orbits[i].end());
+            std::swap(orbits[0], orbits[i]);
+            break;
+        }
+    }
+
     UltraSummitSet<BraidTemplate<F>> uss;
-    std::list<BraidTemplate<F>> queue, queue_rcf;
+    for (std::vector<BraidTemplate<F>> &orbit : orbits) {
+        uss.insert(std::move(orbit));
+    }
+    return uss;
+}
+
+/**
+ * @brief Computes the USS of `b`.
+ *
+ * If the class cache is enabled (see `enable_class_cache`), it is looked up
+ * there first, by the canonical representative of `b`, and stored there
+ * otherwise. Its first orbit is still that of `send_to_ultra_summit(b)`,
+ * starting at it, but the other ones may come in another order.
+ *
+ * @param b A braid.
+ * @return Its USS.
+ */
+template <class F>
+UltraSummitSet<BraidTemplate<F>> ultra_summit_set(const BraidTemplate<F> &b) {
+    std::vector<F> mins;
+    std::vector<sint16> prev;
 
     BraidTemplate<F> b2 = send_to_ultra_summit(b);
-    BraidTemplate<F> b2_rcf = b2;
-    b2_rcf.lcf_to_rcf();
 
-    uss.insert(trajectory(b2));
-    queue.push_back(b2);
-    queue_rcf.push_back(b2_rcf);
+    ClassCache *cache = class_cache();
+    if (cache == nullptr || b2.canonical_length() == 0) {
+        return ultra_summit_set(b2, mins, prev);
+    }
 
-    while (!queue.empty()) {
-        std::vector<F> min = min_ultra_summit(queue.front(), queue_rcf.front());
+    BraidTemplate<F> representative =
+        sliding_circuits::canonical_representative(b2);
+    std::string key = class_key('U', representative), bytes;
+    if (!cache->find(key, bytes)) {
+        ultra_summit_set_to_bytes(
+            ultra_summit_set(representative, mins, prev), bytes);
+        cache->insert(key, bytes);
+    }
+    return ultra_summit_set_of_bytes(bytes, b2);
+}
 
-        for (typename std::vector<F>::iterator itf = min.begin();
-             itf != min.end(); itf++) {
-            b2 = queue.front();
-            b2.conjugate(*itf);
+// An USS, with the tree along which its orbits were found: `prev` holds, for
+// each orbit, the index of the orbit it was found from, and `mins` the
+// minimal simple element that conjugated it there (see `tree_path`).
+template <class F> struct UltraSummitTree {
+    UltraSummitSet<BraidTemplate<F>> uss;
+
+    std::vector<F> mins;
+
+    std::vector<sint16> prev;
+
+    inline bool mem(const BraidTemplate<F> &b) const { return uss.mem(b); }
+
+    inline void insert(std::vector<BraidTemplate<F>> &&orbit, sint16 parent,
+                       const F &f) {
+        uss.insert(std::move(orbit));
+        mins.push_back(f);
+        prev.push_back(parent);
+    }
+};
+
+// Orbits are explored breadth-first, one level at a time, an orbit being
+// expanded from the element it was found through. For all orbits of a level
+// concurrently, we compute the minimal simple elements of that element, its
+// conjugates by them, and the trajectories of the conjugates that are not
+// visited yet (which is only read during that phase). The new orbits are then
+// claimed sequentially, in the order of the level and of the minimal simple
+// elements, so that orbits are numbered (and `mins` and `prev` filled)
+// exactly as with a plain FIFO queue, whatever the number of threads.
+//
+// Visited orbits are recorded in a `Visited`, that is either an
+// `UltraSummitTree` or a `FingerprintVisited`: its `mem` is called
+// concurrently, and its `insert(orbit, parent, f)` is called on each new
+// orbit.
+//
+// The search is run one level at a time by `step`, so that two of them may be
+// interleaved (see `are_conjugate`).
+template <class F, class Visited = UltraSummitTree<F>>
+class UltraSummitSearch {
+  private:
+    // The element an orbit was found through, with its rcf, which is
+    // computed when it is expanded from its parent's. `parent` is its
+    // parent's index in the previous level (or -1 for the first orbit), and
+    // `f` the minimal simple element it was obtained by conjugating with.
+    // `children` holds the conjugates found when expanding it, with the
+    // minimal simple elements that gave them and their trajectories.
+    struct Element {
+        BraidTemplate<F> b;
+        BraidTemplate<F> b_rcf;
+        sint16 parent;
+        F f;
+        std::vector<std::tuple<BraidTemplate<F>, F,
+                               std::vector<BraidTemplate<F>>>>
+            children;
+    };
+
+    typename F::Parameter n;
+
+    Visited visited;
+
+    std::vector<Element> level, previous_level;
+
+    // Index of the first orbit of `previous_level`.
+    sint16 first;
+
+  public:
+    // Starts a search from `b`, which has to be ultra summit.
+    explicit UltraSummitSearch(const BraidTemplate<F> &b)
+        : n(b.get_parameter()), visited(), level(), previous_level(),
+          first(0) {
+        F e(n);
+        e.identity();
+
+        BraidTemplate<F> b_rcf = b;
+        b_rcf.lcf_to_rcf();
+
+        visited.insert(trajectory(b), 0, e);
+        level.push_back(Element{b, b_rcf, -1, e, {}});
+    }
+
+    // Whether the whole USS has been explored.
+    inline bool is_over() const { return level.empty(); }
+
+    // Number of orbits that are to be expanded by the next step.
+    inline size_t frontier_size() const { return level.size(); }
+
+    inline const UltraSummitSet<BraidTemplate<F>> &set() const {
+        return visited.uss;
+    }
+
+    inline const std::vector<F> &get_mins() const { return visited.mins; }
+
+    inline const std::vector<sint16> &get_prev() const { return visited.prev; }
+
+    /**
+     * @brief Explores one more level.
+     *
+     * @tparam Discover A class of functions of signature
+     * `bool _(const std::vector<BraidTemplate<F>> &)`.
+     * @param discover Called on each new orbit (the element it was found
+     * through coming first), from the calling thread, before it is recorded.
+     * Returns whether the search should go on.
+     * @return Whether `discover` returned `false`, in which case the step
+     * stops right away (once that orbit is recorded), and the search should
+     * not go on.
+     */
+    template <class Discover> bool step(Discover discover) {
+        auto expand = [this](Element &e) {
+            if (e.parent >= 0) {
+                e.b_rcf = previous_level[e.parent].b_rcf;
+                e.b_rcf.conjugate_rcf(e.f);
+            }
+
+            std::vector<F> min = min_ultra_summit(e.b, e.b_rcf);
+
+            for (typename std::vector<F>::iterator itf = min.begin();
+                 itf != min.end(); itf++) {
+                BraidTemplate<F> b3 = e.b;
+                b3.conjugate(*itf);
+
+                if (!visited.mem(b3)) {
+                    std::vector<BraidTemplate<F>> t = trajectory(b3);
+                    e.children.emplace_back(std::move(b3), *itf,
+                                            std::move(t));
+                }
+            }
+        };
 
-            if (!uss.mem(b2)) {
-                b2_rcf = queue_rcf.front();
-                b2_rcf.conjugate_rcf(*itf);
+#ifndef USE_PAR
+
+        std::for_each(level.begin(), level.end(), expand);
+
+#else
+
+        std::for_each(std::execution::par, level.begin(), level.end(), expand);
 
-                uss.insert(trajectory(b2));
-                queue.push_back(b2);
-                queue_rcf.push_back(b2_rcf);
+#endif
+
+        first += previous_level.size();
+        previous_level.clear();
+        std::swap(level, previous_level);
+
+        // Several conjugates found in the same level may lie in the same
+        // orbit: only the first one claims it.
+        for (sint16 i = 0; i < sint16(previous_level.size()); i++) {
+            for (auto &child : previous_level[i].children) {
+                if (!visited.mem(std::get<0>(child))) {
+                    bool go_on = discover(std::get<2>(child));
+                    visited.insert(std::move(std::get<2>(child)), first + i,
+                                   std::get<1>(child));
+                    if (!go_on) {
+                        return true;
+                    }
+                    level.push_back(Element{std::move(std::get<0>(child)),
+                                            BraidTemplate<F>(n), i,
+                                            std::get<1>(child), {}});
+                }
             }
+            previous_level[i].children.clear();
         }
-        queue.pop_front();
-        queue_rcf.pop_front();
+
+        return false;
+    }
+
+    /**
+     * @brief Explores one more level.
+     *
+     * @param other An USS that is being explored alongside, or `nullptr`.
+     * @param meet Set to an element of both USSs, if one is found.
+     * @return Whether an orbit of `other` was found, in which case the step
+     * stops right away, and the search should not go on.
+     */
+    bool step(const UltraSummitSet<BraidTemplate<F>> *other,
+              BraidTemplate<F> &meet) {
+        return step([other, &meet](const std::vector<BraidTemplate<F>> &t) {
+            if (other != nullptr && other->mem(t[0])) {
+                meet = t[0];
+                return false;
+            }
+            return true;
+        });
     }
-    return uss;
-}
+
+    // Explores the rest of the USS, and moves it (and the tree) out.
+    UltraSummitSet<BraidTemplate<F>> finish(std::vector<F> &tree_mins,
+                                            std::vector<sint16> &tree_prev) {
+        BraidTemplate<F> meet(n);
+        while (!is_over()) {
+            step(nullptr, meet);
+        }
+        tree_mins = std::move(visited.mins);
+        tree_prev = std::move(visited.prev);
+        return std::move(visited.uss);
+    }
+};
 
 template <class F>
 UltraSummitSet<BraidTemplate<F>> ultra_summit_set(const BraidTemplate<F> &b,
                                                   std::vector<F> &mins,
                                                   std::vector<sint16> &prev) {
-    UltraSummitSet<BraidTemplate<F>> uss;
-    std::list<BraidTemplate<F>> queue, queue_rcf;
+    UltraSummitSearch<F> search(send_to_ultra_summit(b));
+    return search.finish(mins, prev);
+}
 
-    sint16 current = 0;
-    mins.clear();
-    prev.clear();
-    mins.push_back(F(b.get_parameter()));
-    mins[0].identity();
-    prev.push_back(0);
+/**
+ * @brief Visits the ultra summit set of `b`, without storing it.
+ *
+ * Orbits are discovered as in `ultra_summit_set` (and in the same order),
+ * and `visit` is called on the elements of each orbit as soon as it is, from
+ * the calling thread. Only the current level of the search and the
+ * fingerprints (hashes) of visited elements are kept in memory, so that the
+ * set is not materialized. Two elements with the same hash are confused (see
+ * `FingerprintSet`).
+ *
+ * @tparam F The factor class.
+ * @tparam Visit A class of functions of signature
+ * `bool _(const BraidTemplate<F> &)`, that return whether the enumeration
+ * should go on.
+ * @param b A braid.
+ * @param visit The function to call on each element.
+ * @return Whether all elements were visited (i.e., `visit` never returned
+ * `false`).
+ */
+template <class F, class Visit>
+bool for_each_ultra_summit(const BraidTemplate<F> &b, Visit visit) {
+    auto discover = [&visit](const std::vector<BraidTemplate<F>> &t) {
+        for (const BraidTemplate<F> &b3 : t) {
+            if (!visit(b3)) {
+                return false;
+            }
+        }
+        return true;
+    };
 
     BraidTemplate<F> b2 = send_to_ultra_summit(b);
-    BraidTemplate<F> b2_rcf = b2;
-    b2_rcf.lcf_to_rcf();
+    if (!discover(trajectory(b2))) {
+        return false;
+    }
+
+    UltraSummitSearch<F, FingerprintVisited<BraidTemplate<F>>> search(b2);
+    while (!search.is_over()) {
+        if (search.step(discover)) {
+            return false;
+        }
+    }
 
-    uss.insert(trajectory(b2));
-    queue.push_back(b2);
-    queue_rcf.push_back(b2_rcf);
+    return true;
+}
 
-    while (!queue.empty()) {
-        std::vector<F> min = min_ultra_summit(queue.front(), queue_rcf.front());
+/**
+ * @brief Computes the ultra summit set of `b` into a file, spilling to disk.
+ *
+ * Orbits are explored with `external_bfs`, so that memory use is bounded by
+ * `options.memory_budget` rather than by the size of the set. Each orbit is
+ * written to `path` as a record whose key is the smallest binary encoding of
+ * its elements (see `BraidTemplate::to_bytes`), so that it does not depend on
+ * the element the orbit was found through. The payload is the index of the
+ * parent orbit (see `append_index`), followed by the encodings of the
+ * minimal simple element it was obtained by conjugating with and of the
+ * element it was found through. Orbits are in the same levels as with
+ * `ultra_summit_set`, but sorted by key within a level. The file may be read
+ * back with `ultra_summit_set_of_file`.
+ *
+ * @param b A braid.
+ * @param path The file to write to. It is overwritten.
+ * @param options Where temporary files go, and how much memory to use.
+ * @return The number of orbits of the ultra summit set.
+ */
+template <class F>
+std::size_t ultra_summit_set_to_file(const BraidTemplate<F> &b,
+                                     const std::string &path,
+                                     const SpillOptions &options) {
+    typename F::Parameter n = b.get_parameter();
+    F e(n);
+    e.identity();
+
+    // The record of the orbit of `b3`, found from orbit `index` through `f`.
+    auto record = [](const BraidTemplate<F> &b3, std::size_t index,
+                     const F &f) {
+        SpillRecord r;
+        std::string bytes;
+        for (const BraidTemplate<F> &b4 : trajectory(b3)) {
+            bytes.clear();
+            b4.to_bytes(bytes);
+            if (r.key.empty() || bytes < r.key) {
+                std::swap(r.key, bytes);
+            }
+        }
+        append_index(r.payload, index);
+        f.to_bytes(r.payload);
+        b3.to_bytes(r.payload);
+        return r;
+    };
+
+    auto expand = [n, &record](const SpillRecord &r, std::size_t index,
+                               std::vector<SpillRecord> &out) {
+        BraidTemplate<F> b2(n);
+        F f(n);
+        size_t pos = 0;
+        read_index(r.payload, pos);
+        f.of_bytes(r.payload, pos);
+        b2.of_bytes(r.payload, pos);
+        BraidTemplate<F> b2_rcf = b2;
+        b2_rcf.lcf_to_rcf();
+
+        std::vector<F> min = min_ultra_summit(b2, b2_rcf);
 
         for (typename std::vector<F>::iterator itf = min.begin();
              itf != min.end(); itf++) {
-            b2 = queue.front();
-            b2.conjugate(*itf);
+            BraidTemplate<F> b3 = b2;
+            b3.conjugate(*itf);
+            out.push_back(record(b3, index, *itf));
+        }
+    };
 
-            if (!uss.mem(b2)) {
-                b2_rcf = queue_rcf.front();
-                b2_rcf.conjugate_rcf(*itf);
+    return external_bfs(record(send_to_ultra_summit(b), 0, e), expand, path,
+                        options);
+}
 
-                uss.insert(trajectory(b2));
-                queue.push_back(b2);
-                queue_rcf.push_back(b2_rcf);
+/**
+ * @brief Reads an ultra summit set written by `ultra_summit_set_to_file`.
+ *
+ * @param path The file to read from.
+ * @param n The parameter of its elements.
+ * @param mins Set to the minimal simple elements orbits were found through,
+ * as with `ultra_summit_set`.
+ * @param prev Set to the orbits orbits were found from, as with
+ * `ultra_summit_set`.
+ * @return The ultra summit set, with orbits in the order of the file.
+ * @exception InvalidStringError Thrown when the file is not as expected.
+ */
+template <class F>
+UltraSummitSet<BraidTemplate<F>>
+ultra_summit_set_of_file(const std::string &path, typename F::Parameter n,
+                         std::vector<F> &mins, std::vector<sint16> &prev) {
+    UltraSummitSet<BraidTemplate<F>> uss;
+    RecordReader in(path);
+    SpillRecord r;
+    BraidTemplate<F> b(n);
+    F f(n);
 
-                mins.push_back(*itf);
-                prev.push_back(current);
-            }
-        }
-        queue.pop_front();
-        queue_rcf.pop_front();
+    mins.clear();
+    prev.clear();
 
-        current++;
+    while (in.next(r)) {
+        size_t pos = 0;
+        sint16 parent = read_index(r.payload, pos);
+        f.of_bytes(r.payload, pos);
+        b.of_bytes(r.payload, pos);
+        uss.insert(trajectory(b));
+        mins.push_back(f);
+        prev.push_back(parent);
     }
+
     return uss;
 }
 
+/**
+ * @brief Computes the ultra summit set of `b`, spilling to disk while
+ * exploring it.
+ *
+ * Runs `ultra_summit_set_to_file` on a temporary file in
+ * `options.directory`, and reads the result back.
+ *
+ * @param b A braid.
+ * @param mins Set as with `ultra_summit_set`.
+ * @param prev Set as with `ultra_summit_set`.
+ * @param options Where temporary files go, and how much memory to use.
+ * @return The ultra summit set of `b`.
+ */
+template <class F>
+UltraSummitSet<BraidTemplate<F>>
+ultra_summit_set(const BraidTemplate<F> &b, std::vector<F> &mins,
+                 std::vector<sint16> &prev, const SpillOptions &options) {
+    SpillDirectory directory(options.directory);
+    std::string path = directory.file();
+    ultra_summit_set_to_file(b, path, options);
+    return ultra_summit_set_of_file<F>(path, b.get_parameter(), mins, prev);
+}
+
 template <class F>
 BraidTemplate<F> tree_path(const BraidTemplate<F> &b,
                            const UltraSummitSet<BraidTemplate<F>> &uss,
@@ -681,11 +1183,10 @@ BraidTemplate<F> tree_path(const BraidTemplate<F> &b,
     }
 
     sint16 current = uss.find_orbit(b);
+    size_t shift = uss.find_shift(b);
 
-    for (typename std::vector<BraidTemplate<F>>::const_iterator itb =
-             uss.orbits[current].begin();
-         *itb != b; itb++) {
-        c.right_multiply((*itb).first().delta_conjugate(b.inf()));
+    for (size_t i = 0; i < shift; i++) {
+        c.right_multiply(uss.at(size_t(current), i).initial());
     }
 
     while (current != 0) {
@@ -696,10 +1197,37 @@ BraidTemplate<F> tree_path(const BraidTemplate<F> &b,
     return c;
 }
 
+/**
+ * @brief Conjugacy test, with a certificate and a prefilter.
+ *
+ * `filter` is run first, and the summit sets are only looked at if it does
+ * not tell `b1` and `b2` apart.
+ *
+ * Both braids are sent to their USS, which are then explored alongside,
+ * one level at a time (the one with the smaller frontier going first),
+ * until an orbit is found by both searches, or one of them is over. The
+ * conjugator is then read along both BFS trees. When the braids are
+ * conjugate, this usually stops long before either USS is complete.
+ *
+ * @param b1 A braid.
+ * @param b2 A braid.
+ * @param c A braid that is set, when `b1` and `b2` are conjugate, to a
+ * conjugator `c` such that `b2` is the conjugate of `b1` by `c`.
+ * @param filter A pipeline of conjugacy invariants.
+ * @param decided_by Set to what decided the answer: the name of a test of
+ * `filter`, `"summit infimum and supremum"`, or `"ultra summit set"`.
+ * @return Whether `b1` and `b2` are conjugate.
+ */
 template <class F>
 bool are_conjugate(const BraidTemplate<F> &b1, const BraidTemplate<F> &b2,
-                   BraidTemplate<F> &c) {
-    sint16 n = b1.get_parameter();
+                   BraidTemplate<F> &c,
+                   const InvariantFilter<BraidTemplate<F>> &filter,
+                   std::string &decided_by) {
+    if (!filter.may_be_conjugate(b1, b2, decided_by)) {
+        return false;
+    }
+
+    typename F::Parameter n = b1.get_parameter();
     BraidTemplate<F> c1 = BraidTemplate<F>(n), c2 = BraidTemplate<F>(n);
 
     BraidTemplate<F> bt1 = send_to_ultra_summit(b1, c1),
@@ -707,27 +1235,64 @@ bool are_conjugate(const BraidTemplate<F> &b1, const BraidTemplate<F> &b2,
 
     if (bt1.canonical_length() != bt2.canonical_length() ||
         bt1.sup() != bt2.sup()) {
+        decided_by = "summit infimum and supremum";
         return false;
     }
 
+    decided_by = "ultra summit set";
+
     if (bt1.canonical_length() == 0) {
         c = c1 * !c2;
         return true;
     }
 
-    std::vector<F> mins;
-    std::vector<sint16> prev;
+    UltraSummitSearch<F> search1(bt1), search2(bt2);
 
-    UltraSummitSet<BraidTemplate<F>> uss = ultra_summit_set(bt1, mins, prev);
+    // An element of both USSs. Each search checks the orbits it finds
+    // against the other one's, so that their first orbits have to be
+    // checked here.
+    BraidTemplate<F> meet = bt2;
+    bool met = search1.set().mem(bt2);
 
-    if (!uss.mem(bt2)) {
-        return false;
+    while (!met) {
+        if (search1.is_over() || search2.is_over()) {
+            return false;
+        }
+        met = search1.frontier_size() <= search2.frontier_size()
+                  ? search1.step(&search2.set(), meet)
+                  : search2.step(&search1.set(), meet);
     }
 
-    c = c1 * tree_path(bt2, uss, mins, prev) * !c2;
+    c = c1 *
+        tree_path(meet, search1.set(), search1.get_mins(),
+                  search1.get_prev()) *
+        !tree_path(meet, search2.set(), search2.get_mins(),
+                   search2.get_prev()) *
+        !c2;
 
     return true;
 }
+/**
+ * @brief Conjugacy test, with a certificate.
+ *
+ * The default pipeline of conjugacy invariants for `BraidTemplate<F>` is
+ * run first (see `default_invariant_filter`).
+ *
+ * @param b1 A braid.
+ * @param b2 A braid.
+ * @param c A braid that is set, when `b1` and `b2` are conjugate, to a
+ * conjugator `c` such that `b2` is the conjugate of `b1` by `c`.
+ * @return Whether `b1` and `b2` are conjugate.
+ */
+template <class F>
+bool are_conjugate(const BraidTemplate<F> &b1, const BraidTemplate<F> &b2,
+                   BraidTemplate<F> &c) {
+    std::string decided_by;
+    return are_conjugate(b1, b2, c,
+                         default_invariant_filter<BraidTemplate<F>>(),
+                         decided_by);
+}
+
 } // namespace garcide::ultra_summit
 
 #endif
\ No newline at end of file
@@ -36,11 +36,16 @@
 
 #endif
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <ostream>
-#include <regex>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace garcide {
 
@@ -93,15 +98,6 @@ typedef long long sint64;
  */
 typedef unsigned long long uint64;
 
-/**
- * @brief Regex representing integers.
- *
- * A regular expression that matches well-formed integers.
- * It is a string because we often add it as a part of more complex regular
- * expressions, and there is no way to build them within `std::regex`.
- */
-const std::string number_regex{"-?[1-9][0-9]*|0"};
-
 /**
  * @brief Euclidean quotient.
  *
@@ -139,6 +135,93 @@ inline sint16 Rem(sint16 a, sint16 b) {
     return r >= 0 ? r : r + (b >= 0 ? b : -b);
 };
 
+/**
+ * @brief Mixes the bits of a 64-bit integer.
+ *
+ * The SplitMix64 finalizer: every bit of the result depends on every bit of
+ * `x`, so that it may be used as a hash for values whose entropy sits in a
+ * few bits (small integers, identifiers).
+ *
+ * @param x The integer to mix.
+ * @return The mixed integer.
+ */
+inline uint64 hash_mix(uint64 x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * @brief Full 64-bit multiplication, folded.
+ *
+ * Multiplies `a` by `b` into 128 bits, and XORs the two halves of the
+ * result together. This is the core step of wyhash.
+ *
+ * @param a First factor.
+ * @param b Second factor.
+ * @return The XOR of the low and high halves of `a * b`.
+ */
+inline uint64 hash_fold(uint64 a, uint64 b) {
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 r = uint128(a) * b;
+    return uint64(r) ^ uint64(r >> 64);
+#else
+    uint64 a_low = a & 0xFFFFFFFF, a_high = a >> 32, b_low = b & 0xFFFFFFFF,
+           b_high = b >> 32;
+    uint64 low = a_low * b_low, middle_1 = a_high * b_low,
+           middle_2 = a_low * b_high, high = a_high * b_high;
+    uint64 carry = ((low >> 32) + (middle_1 & 0xFFFFFFFF) +
+                    (middle_2 & 0xFFFFFFFF)) >>
+                   32;
+    return (low + (middle_1 << 32) + (middle_2 << 32)) ^
+           (high + (middle_1 >> 32) + (middle_2 >> 32) + carry);
+#endif
+}
+
+/**
+ * @brief Combines a hash with a new value.
+ *
+ * Used to hash sequences: start from any seed, and combine the values in
+ * order. Unlike `h * 31 + v`, every bit of `v` affects every bit of the
+ * result.
+ *
+ * @param h The hash of the preceding values.
+ * @param v The new value.
+ * @return The hash of the extended sequence.
+ */
+inline uint64 hash_combine(uint64 h, uint64 v) {
+    return hash_fold(h ^ 0xA0761D6478BD642Full, v ^ 0xE7037ED1A0B428DBull);
+}
+
+/**
+ * @brief Hashes a byte array.
+ *
+ * Reads `length` bytes from `data`, 8 at a time.
+ *
+ * @param data The start of the array.
+ * @param length The number of bytes.
+ * @return The hash of the array.
+ */
+inline uint64 hash_bytes(const void *data, std::size_t length) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    uint64 h = hash_mix(length), word;
+    std::size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        std::memcpy(&word, bytes + i, 8);
+        h = hash_combine(h, word);
+    }
+    if (i < length) {
+        word = 0;
+        std::memcpy(&word, bytes + i, length - i);
+        h = hash_combine(h, word);
+    }
+    return hash_mix(h);
+}
+
 /**
  * @brief Exception thrown in case of bad input.
  *
@@ -172,6 +255,293 @@ struct InvalidStringError {
  */
 struct NonRandomizable {};
 
+/**
+ * @brief Appends an unsigned integer to a byte string, as a varint.
+ *
+ * Seven bits are stored per byte, low bits first, the high bit of each byte
+ * telling whether more follow. Small integers thus take a single byte.
+ *
+ * @param bytes The byte string to append to.
+ * @param x The integer to append.
+ */
+inline void append_varint(std::string &bytes, uint64 x) {
+    while (x >= 0x80) {
+        bytes.push_back(char((x & 0x7F) | 0x80));
+        x >>= 7;
+    }
+    bytes.push_back(char(x));
+}
+
+/**
+ * @brief Reads a varint from a byte string.
+ *
+ * @param bytes The byte string to read from.
+ * @param pos The position to start from. It is set past the varint.
+ * @exception InvalidStringError Thrown when `bytes` ends before the varint
+ * does.
+ * @return The integer that was read.
+ */
+inline uint64 read_varint(const std::string &bytes, size_t &pos) {
+    uint64 x = 0;
+    for (sint16 shift = 0; shift < 64; shift += 7) {
+        if (pos >= bytes.size()) {
+            throw InvalidStringError("Truncated varint!");
+        }
+        uint8 byte = uint8(bytes[pos++]);
+        x |= uint64(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            return x;
+        }
+    }
+    throw InvalidStringError("Varint is too long!");
+}
+
+/**
+ * @brief A substring, as a position and a length.
+ *
+ * Used by the lexing functions below to point at what they matched without
+ * copying it.
+ */
+struct StringSpan {
+    size_t start = 0;
+
+    size_t length = 0;
+
+    /**
+     * @brief Copies the substring of `str` spanned by `*this`.
+     *
+     * Only meant for error messages.
+     *
+     * @param str The string `*this` points into.
+     * @return The substring.
+     */
+    std::string of(const std::string &str) const {
+        return str.substr(start, length);
+    }
+};
+
+/**
+ * @brief Tells whether `c` is a whitespace.
+ *
+ * Whitespaces are spaces, tabs, line feeds, carriage returns, vertical tabs
+ * and form feeds, that is, characters matched by `[\s\t]` in regular
+ * expressions.
+ *
+ * @param c A character.
+ * @return Whether `c` is a whitespace.
+ */
+inline bool is_whitespace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * @brief Skips whitespaces.
+ *
+ * Moves `pos` forward past the whitespaces of `str` that start there.
+ *
+ * @param str The string being read.
+ * @param pos The current position in `str`.
+ */
+inline void skip_whitespaces(const std::string &str, size_t &pos) {
+    while (pos < str.length() && is_whitespace(str[pos])) {
+        pos++;
+    }
+}
+
+/**
+ * @brief Matches a character.
+ *
+ * If `c` is at `pos` in `str`, moves `pos` past it.
+ *
+ * @param str The string being read.
+ * @param pos The current position in `str`.
+ * @param c The character to match.
+ * @return Whether `c` was matched.
+ */
+inline bool match_char(const std::string &str, size_t &pos, char c) {
+    if (pos < str.length() && str[pos] == c) {
+        pos++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Matches an integer.
+ *
+ * Integers are the words of `Z = -? ([1 - 9] [0 - 9]* | 0)`. If one starts at
+ * `pos` in `str`, `span` is set to the longest one, and `pos` is moved past
+ * it.
+ *
+ * @param str The string being read.
+ * @param pos The current position in `str`.
+ * @param span Set to the integer's position and length.
+ * @return Whether an integer was matched.
+ */
+inline bool match_integer(const std::string &str, size_t &pos,
+                          StringSpan &span) {
+    size_t end = pos;
+    if (end < str.length() && str[end] == '-') {
+        end++;
+    }
+    if (end < str.length() && str[end] >= '1' && str[end] <= '9') {
+        end++;
+        while (end < str.length() && str[end] >= '0' && str[end] <= '9') {
+            end++;
+        }
+    } else if (end == pos && end < str.length() && str[end] == '0') {
+        end++;
+    } else {
+        return false;
+    }
+    span.start = pos;
+    span.length = end - pos;
+    pos = end;
+    return true;
+}
+
+/**
+ * @brief Matches a pair of integers.
+ *
+ * Pairs are the words of `'(' W Z W ','? W Z W ')'`, where `W` matches
+ * whitespaces and `Z` integers. If one starts at `pos` in `str`, `pos` is
+ * moved past it. Otherwise, `pos` is left unchanged.
+ *
+ * @param str The string being read.
+ * @param pos The current position in `str`.
+ * @param first Set to the first integer's position and length.
+ * @param second Set to the second integer's position and length.
+ * @return Whether a pair was matched.
+ */
+inline bool match_integer_pair(const std::string &str, size_t &pos,
+                               StringSpan &first, StringSpan &second) {
+    size_t end = pos;
+    if (!match_char(str, end, '(')) {
+        return false;
+    }
+    skip_whitespaces(str, end);
+    if (!match_integer(str, end, first)) {
+        return false;
+    }
+    skip_whitespaces(str, end);
+    match_char(str, end, ',');
+    skip_whitespaces(str, end);
+    if (!match_integer(str, end, second)) {
+        return false;
+    }
+    skip_whitespaces(str, end);
+    if (!match_char(str, end, ')')) {
+        return false;
+    }
+    pos = end;
+    return true;
+}
+
+/**
+ * @brief Matches a subscripted letter.
+ *
+ * Subscripted letters are the words of `letter W '_'? W Z`, where `W` matches
+ * whitespaces and `Z` integers (e.g. `s_3` or `e 2`). If one starts at `pos`
+ * in `str`, `pos` is moved past it. Otherwise, `pos` is left unchanged.
+ *
+ * @param str The string being read.
+ * @param pos The current position in `str`.
+ * @param letter The letter.
+ * @param span Set to the subscript's position and length.
+ * @return Whether a subscripted `letter` was matched.
+ */
+inline bool match_subscripted(const std::string &str, size_t &pos, char letter,
+                              StringSpan &span) {
+    size_t end = pos;
+    if (!match_char(str, end, letter)) {
+        return false;
+    }
+    skip_whitespaces(str, end);
+    match_char(str, end, '_');
+    skip_whitespaces(str, end);
+    if (!match_integer(str, end, span)) {
+        return false;
+    }
+    pos = end;
+    return true;
+}
+
+/**
+ * @brief Converts an integer.
+ *
+ * Converts the integer spanned by `span` in `str`, which should have been
+ * matched by `match_integer`.
+ *
+ * @tparam T An integer type.
+ * @param str The string that was read.
+ * @param span The integer's position and length.
+ * @param what What the integer stands for, used in error messages.
+ * @exception InvalidStringError Thrown when the integer does not fit in a
+ * `T`.
+ * @return The integer.
+ */
+template <class T = sint16>
+T integer_of_string(const std::string &str, StringSpan span,
+                    const char *what) {
+    bool is_negative = str[span.start] == '-';
+    uint64 bound = is_negative ? uint64(0) - uint64(std::numeric_limits<T>::min())
+                               : uint64(std::numeric_limits<T>::max()),
+           value = 0;
+    for (size_t i = span.start + (is_negative ? 1 : 0);
+         i < span.start + span.length; i++) {
+        uint64 digit = str[i] - '0';
+        if (value > (bound - digit) / 10) {
+            throw InvalidStringError(std::string(what) + " is too big!\n" +
+                                     span.of(str) +
+                                     " can not be converted to a C++ integer.");
+        }
+        value = 10 * value + digit;
+    }
+    return is_negative ? T(uint64(0) - value) : T(value);
+}
+
+/**
+ * @brief Matches a whole string against `W Z W`.
+ *
+ * `W` matches whitespaces and `Z` integers. This is how parameters are
+ * usually entered.
+ *
+ * @param str The string to match.
+ * @param span Set to the integer's position and length.
+ * @return Whether `str` is matched.
+ */
+inline bool match_whole_integer(const std::string &str, StringSpan &span) {
+    size_t pos = 0;
+    skip_whitespaces(str, pos);
+    if (!match_integer(str, pos, span)) {
+        return false;
+    }
+    skip_whitespaces(str, pos);
+    return pos == str.length();
+}
+
+/**
+ * @brief Matches a whole string against `W P W`.
+ *
+ * `W` matches whitespaces and `P` pairs of integers (see
+ * `match_integer_pair`).
+ *
+ * @param str The string to match.
+ * @param first Set to the first integer's position and length.
+ * @param second Set to the second integer's position and length.
+ * @return Whether `str` is matched.
+ */
+inline bool match_whole_integer_pair(const std::string &str,
+                                     StringSpan &first, StringSpan &second) {
+    size_t pos = 0;
+    skip_whitespaces(str, pos);
+    if (!match_integer_pair(str, pos, first, second)) {
+        return false;
+    }
+    skip_whitespaces(str, pos);
+    return pos == str.length();
+}
+
 /**
  * @brief Forward iterates applications of `f` on pairs of successive elements.
  *
@@ -260,6 +630,89 @@ inline void bubble_sort(ForItr first, ForItr last, BinFun f) {
         apply_binfun(--i, last, f);
 }
 
+/**
+ * @brief Iterates `step` from `x` until a repetition occurs, keeping the
+ * iterates.
+ *
+ * Sets `t` to `x_0 = x`, `x_1 = step(x_0)`, ..., up to (and excluding) the
+ * first `x_k` that is equal to an earlier `x_mu`.
+ *
+ * Repetitions are looked for through the iterates' hashes, that point to
+ * their position in `t`: no other copy of them is kept.
+ *
+ * Linear in the number of iterates.
+ *
+ * @tparam T A hashable, equality comparable class.
+ * @tparam Step A class of functions of signature `void _(T &)`.
+ * @param x The first iterate.
+ * @param step A function that sets its argument to the next iterate.
+ * @param t Set to the iterates, up to the first repetition.
+ * @return The index `mu` of the first iterate that comes again (`t` is then
+ * made of `mu` iterates, followed by a cycle).
+ */
+template <class T, class Step>
+std::size_t iterate_until_repetition(T x, Step step, std::vector<T> &t) {
+    std::unordered_multimap<std::size_t, std::size_t> positions;
+    t.clear();
+    while (true) {
+        std::size_t h = std::hash<T>()(x);
+        auto range = positions.equal_range(h);
+        for (auto it = range.first; it != range.second; it++) {
+            if (t[it->second] == x) {
+                return it->second;
+            }
+        }
+        positions.emplace(h, t.size());
+        t.push_back(x);
+        step(x);
+    }
+}
+
+/**
+ * @brief Iterates `step` from `x` until a repetition occurs, only keeping
+ * the iterates' hashes.
+ *
+ * Finds the first `x_mu` (in the notations of `iterate_until_repetition`)
+ * that comes again, without keeping the iterates: only a constant number of
+ * them is held at any time. When an iterate's hash was already seen, the
+ * iterate it may be equal to is recomputed from `x` to check it, so that
+ * iterates up to `x_mu` are computed twice.
+ *
+ * @tparam T A hashable, equality comparable class.
+ * @tparam Step A class of functions of signature `void _(T &)`.
+ * @param x The first iterate.
+ * @param step A function that sets its argument to the next iterate.
+ * @param entry Set to `x_mu`.
+ * @return `mu`.
+ */
+template <class T, class Step>
+std::size_t find_repetition(const T &x, Step step, T &entry) {
+    std::unordered_multimap<std::size_t, std::size_t> positions;
+    std::vector<std::size_t> candidates;
+    T y = x;
+    for (std::size_t k = 0;; k++) {
+        std::size_t h = std::hash<T>()(y);
+        auto range = positions.equal_range(h);
+        candidates.clear();
+        for (auto it = range.first; it != range.second; it++) {
+            candidates.push_back(it->second);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        entry = x;
+        std::size_t i = 0;
+        for (std::size_t mu : candidates) {
+            for (; i < mu; i++) {
+                step(entry);
+            }
+            if (entry == y) {
+                return mu;
+            }
+        }
+        positions.emplace(h, k);
+        step(y);
+    }
+}
+
 /**
  * @brief A struct that represents a endline character.
  *
@@ -0,0 +1,185 @@
+/**
+ * @file class_cache.cpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Implementation file for the persistent conjugacy class cache.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "garcide/class_cache.h"
+#include "garcide/external_bfs.hpp"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CLASS_CACHE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace garcide {
+
+namespace {
+
+// Reads a varint from `data`, that ends at `end`. Returns `false` if it is
+// truncated.
+bool read_mapped_varint(const char *data, std::size_t end, std::size_t &pos,
+                        uint64 &x) {
+    x = 0;
+    for (sint16 shift = 0; shift < 64 && pos < end; shift += 7) {
+        unsigned char c = data[pos++];
+        x |= uint64(c & 0x7F) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Maps the file at `path`, which has size `size`. Without `mmap`, it is read
+// into a buffer instead.
+const char *map_file(const std::string &path, std::size_t size) {
+#ifdef CLASS_CACHE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open " + path + "!");
+    }
+    void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        throw std::runtime_error("Could not map " + path + "!");
+    }
+    return static_cast<const char *>(p);
+#else
+    std::unique_ptr<char[]> buffer(new char[size]);
+    std::ifstream in(path, std::ios::binary);
+    if (!in.read(buffer.get(), size)) {
+        throw std::runtime_error("Could not read " + path + "!");
+    }
+    return buffer.release();
+#endif
+}
+
+void unmap_file(const char *data, std::size_t size) {
+#ifdef CLASS_CACHE_MMAP
+    ::munmap(const_cast<char *>(data), size);
+#else
+    (void)size;
+    delete[] data;
+#endif
+}
+
+std::unique_ptr<ClassCache> enabled_cache;
+
+} // namespace
+
+ClassCache::ClassCache(const std::string &path)
+    : path(path), mapped(nullptr), mapped_size(0), index(), added(), mutex() {
+    std::error_code ec;
+    std::size_t size = std::filesystem::file_size(path, ec);
+    if (ec || size == 0) {
+        // Creates it, so that appending works.
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        if (!out) {
+            throw std::runtime_error("Could not open " + path + "!");
+        }
+        return;
+    }
+
+    mapped = map_file(path, size);
+    mapped_size = size;
+
+    std::size_t pos = 0, valid = 0;
+    while (pos < mapped_size) {
+        uint64 key_length, value_length;
+        if (!read_mapped_varint(mapped, mapped_size, pos, key_length) ||
+            key_length > mapped_size - pos) {
+            break;
+        }
+        std::string_view key(mapped + pos, key_length);
+        pos += key_length;
+        if (!read_mapped_varint(mapped, mapped_size, pos, value_length) ||
+            value_length > mapped_size - pos) {
+            break;
+        }
+        index.emplace(key, std::make_pair(pos, std::size_t(value_length)));
+        pos += value_length;
+        valid = pos;
+    }
+
+    if (valid < mapped_size) {
+        std::filesystem::resize_file(path, valid);
+    }
+}
+
+ClassCache::~ClassCache() {
+    if (mapped != nullptr) {
+        unmap_file(mapped, mapped_size);
+    }
+}
+
+bool ClassCache::find(const std::string &key, std::string &value) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(std::string_view(key));
+    if (it != index.end()) {
+        value.assign(mapped + it->second.first, it->second.second);
+        return true;
+    }
+    auto it_added = added.find(key);
+    if (it_added != added.end()) {
+        value = it_added->second;
+        return true;
+    }
+    return false;
+}
+
+void ClassCache::insert(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (index.count(std::string_view(key)) != 0 || added.count(key) != 0) {
+        return;
+    }
+    RecordWriter writer(path, true);
+    writer.write(key, value);
+    writer.close();
+    added.emplace(key, value);
+}
+
+std::size_t ClassCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.size() + added.size();
+}
+
+void enable_class_cache(const std::string &path) {
+    enabled_cache.reset();
+    enabled_cache.reset(new ClassCache(path));
+}
+
+void disable_class_cache() { enabled_cache.reset(); }
+
+ClassCache *class_cache() { return enabled_cache.get(); }
+
+} // namespace garcide
@@ -28,6 +28,7 @@
  */
 
 #include "garcide/groups/artin.h"
+#include "garcide/permutation.h"
 
 namespace garcide {
 
@@ -35,26 +36,17 @@ namespace artin {
 
 Underlying::Parameter
 Underlying::parameter_of_string(const std::string &str) {
-    std::smatch match;
-
-    if (std::regex_match(str, match,
-                         std::regex{"[\\s\\t]*(" + number_regex + ")[\\s\\t]*"},
-                         std::regex_constants::match_continuous)) {
-        sint16 i;
-        try {
-            i = std::stoi(match[1]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Number of strands is too big!\n" +
-                                     match.str(1) +
-                                     " can not be converted to a C++ integer.");
-        }
+    StringSpan span;
+
+    if (match_whole_integer(str, span)) {
+        sint16 i = integer_of_string(str, span, "Number of strands");
         if (((2 <= i) && (i <= MAX_NUMBER_OF_STRANDS))) {
             return i;
         } else if (2 > i) {
             throw InvalidStringError("Number of strands should be at least 2!");
         } else {
             throw InvalidStringError("Number of strands is too big!\n" +
-                                     match.str(1) +
+                                     span.of(str) +
                                      " is strictly greater than " +
                                      std::to_string(MAX_NUMBER_OF_STRANDS) + ".");
         }
@@ -64,9 +56,10 @@ Underlying::parameter_of_string(const std::string &str) {
     }
 };
 
-void Underlying::MeetSub(const sint16 *a, const sint16 *b, sint16 *r, sint16 s,
+void Underlying::MeetSub(const Entry *a, const Entry *b, Entry *r, sint16 s,
                          sint16 t) {
-    thread_local sint16 u[MAX_NUMBER_OF_STRANDS], v[MAX_NUMBER_OF_STRANDS], w[MAX_NUMBER_OF_STRANDS];
+    thread_local Entry u[MAX_NUMBER_OF_STRANDS + 1],
+        v[MAX_NUMBER_OF_STRANDS + 1], w[MAX_NUMBER_OF_STRANDS + 1];
 
     if (s >= t)
         return;
@@ -108,32 +101,20 @@ Underlying::Underlying(Underlying::Parameter n)
 void Underlying::of_string(const std::string &str, size_t &pos) {
     Parameter n = get_parameter();
 
-    std::smatch match;
-
-    if (std::regex_search(str.begin() + pos, str.end(), match,
-                          std::regex{"(" + number_regex + ")"},
-                          std::regex_constants::match_continuous)) {
-        sint16 i;
-        try {
-            i = std::stoi(match[1]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Index is too big!\n" + match.str(1) +
-                                     " can not be converted to a C++ integer.");
-        }
-        pos += match[0].length();
+    StringSpan span;
+
+    if (match_integer(str, pos, span)) {
+        sint16 i = integer_of_string(str, span, "Index");
         if ((i >= 1) && (i < n)) {
             identity();
             permutation_table[i] = i + 1;
             permutation_table[i + 1] = i;
         } else {
             throw InvalidStringError("Invalid index for Artin generator!\n" +
-                                     match.str(1) + " is not in [1, " +
+                                     span.of(str) + " is not in [1, " +
                                      std::to_string(n) + "[.");
         }
-    } else if (std::regex_search(str.begin() + pos, str.end(), match,
-                                 std::regex{"D"},
-                                 std::regex_constants::match_continuous)) {
-        pos += match[0].length();
+    } else if (match_char(str, pos, 'D')) {
         delta();
     } else {
         throw InvalidStringError(std::string(
@@ -205,7 +186,7 @@ void Underlying::delta() {
 };
 
 Underlying Underlying::left_meet(const Underlying &b) const {
-    thread_local sint16 s[MAX_NUMBER_OF_STRANDS];
+    thread_local Entry s[MAX_NUMBER_OF_STRANDS + 1];
 
     Underlying f = Underlying(get_parameter());
 
@@ -220,7 +201,8 @@ Underlying Underlying::left_meet(const Underlying &b) const {
 };
 
 Underlying Underlying::right_meet(const Underlying &b) const {
-    thread_local sint16 u[MAX_NUMBER_OF_STRANDS], v[MAX_NUMBER_OF_STRANDS];
+    thread_local Entry u[MAX_NUMBER_OF_STRANDS + 1],
+        v[MAX_NUMBER_OF_STRANDS + 1];
 
     Underlying f = Underlying(get_parameter());
 
@@ -247,19 +229,15 @@ bool Underlying::compare(const Underlying &b) const {
 
 Underlying Underlying::inverse() const {
     Underlying f = Underlying(get_parameter());
-    sint16 i;
-    for (i = 1; i <= get_parameter(); i++) {
-        f.permutation_table[permutation_table[i]] = i;
-    }
+    permutation::invert(permutation_table.data(), f.permutation_table.data(),
+                        get_parameter() + 1);
     return f;
 };
 
 Underlying Underlying::product(const Underlying &b) const {
     Underlying f = Underlying(get_parameter());
-    sint16 i;
-    for (i = 1; i <= get_parameter(); i++) {
-        f.permutation_table[i] = b.permutation_table[permutation_table[i]];
-    }
+    permutation::compose(permutation_table.data(), b.permutation_table.data(),
+                         f.permutation_table.data(), get_parameter() + 1);
     return f;
 };
 
@@ -268,7 +246,12 @@ Underlying Underlying::left_complement(const Underlying &b) const {
 };
 
 Underlying Underlying::right_complement(const Underlying &b) const {
-    return inverse().product(b);
+    Underlying f = Underlying(get_parameter());
+    permutation::invert_then_compose(permutation_table.data(),
+                                     b.permutation_table.data(),
+                                     f.permutation_table.data(),
+                                     get_parameter() + 1);
+    return f;
 };
 
 void Underlying::randomize() {
@@ -312,11 +295,23 @@ void Underlying::delta_conjugate_mut(sint16 k) {
 }
 
 size_t Underlying::hash() const {
-    size_t h = 0;
+    return hash_bytes(permutation_table.data() + 1,
+                      get_parameter() * sizeof(Entry));
+}
+
+void Underlying::to_bytes(std::string &bytes) const {
     for (sint16 i = 1; i <= get_parameter(); i++) {
-        h = h * 31 + permutation_table[i];
+        bytes.push_back(char(permutation_table[i] - 1));
+    }
+}
+
+void Underlying::of_bytes(const std::string &bytes, size_t &pos) {
+    if (pos + get_parameter() > bytes.size()) {
+        throw InvalidStringError("Truncated factor!");
+    }
+    for (sint16 i = 1; i <= get_parameter(); i++) {
+        permutation_table[i] = Entry(uint8(bytes[pos++]) + 1);
     }
-    return h;
 }
 
 void Underlying::tableau(sint16 **&tab) const {
@@ -454,8 +449,194 @@ thurston_type(const Braid &b,
     return ThurstonType::PseudoAsonov;
 }
 
+sint32 exponent_sum(const Braid &b) {
+    Braid::Parameter n = b.get_parameter();
+
+    sint32 sum = sint32(b.inf()) * (n * (n - 1) / 2);
+
+    // The length of a factor is the number of inversions of its permutation.
+    for (Braid::ConstFactorItr it = b.cbegin(); it != b.cend(); it++) {
+        Underlying u = (*it).get_underlying();
+        for (sint16 i = 1; i <= n; i++) {
+            for (sint16 j = i + 1; j <= n; j++) {
+                if (u.at(i) > u.at(j)) {
+                    sum++;
+                }
+            }
+        }
+    }
+
+    return sum;
+}
+
+namespace {
+
+const uint64 BURAU_PRIME = 2147483647;
+
+uint64 burau_power(uint64 x, uint64 k) {
+    uint64 r = 1;
+    for (x %= BURAU_PRIME; k > 0; k >>= 1, x = x * x % BURAU_PRIME) {
+        if (k & 1) {
+            r = r * x % BURAU_PRIME;
+        }
+    }
+    return r;
+}
+
+// Appends to `w` a word in the Artin generators for `u` (as in `print`).
+void append_word(const Underlying &u, std::vector<sint16> &w) {
+    sint16 n = u.get_parameter();
+    std::vector<sint16> c(n + 1);
+    for (sint16 i = 1; i <= n; i++) {
+        c[i] = u.at(i);
+    }
+    for (sint16 i = 2; i <= n; i++) {
+        for (sint16 j = i; j > 1 && c[j] < c[j - 1]; j--) {
+            w.push_back(j - 1);
+            std::swap(c[j], c[j - 1]);
+        }
+    }
+}
+
+// Right multiplies the `n` by `n` matrix `m` by the unreduced Burau matrix of
+// the `i`-th generator (or of its inverse), evaluated at `t`, whose inverse
+// is `ti`. Only columns `i - 1` and `i` change.
+void burau_multiply(std::vector<uint64> &m, sint16 n, sint16 i, uint64 t,
+                    uint64 ti, bool inverse) {
+    for (sint16 r = 0; r < n; r++) {
+        uint64 &a = m[r * n + i - 1], &b = m[r * n + i];
+        uint64 x = a, y = b;
+        if (!inverse) {
+            a = ((BURAU_PRIME + 1 - t) * x + y) % BURAU_PRIME;
+            b = t * x % BURAU_PRIME;
+        } else {
+            a = ti * y % BURAU_PRIME;
+            b = (x + (BURAU_PRIME + 1 - ti) * y) % BURAU_PRIME;
+        }
+    }
+}
+
+} // namespace
+
+uint64 burau_trace(const Braid &b, uint64 t) {
+    Braid::Parameter n = b.get_parameter();
+    t %= BURAU_PRIME;
+    uint64 ti = burau_power(t, BURAU_PRIME - 2);
+
+    std::vector<uint64> m(n * n, 0);
+    for (sint16 i = 0; i < n; i++) {
+        m[i * n + i] = 1;
+    }
+
+    Underlying delta(n);
+    delta.delta();
+    std::vector<sint16> w;
+    append_word(delta, w);
+
+    for (sint16 k = 0; k < b.inf(); k++) {
+        for (sint16 i : w) {
+            burau_multiply(m, n, i, t, ti, false);
+        }
+    }
+    for (sint16 k = 0; k > b.inf(); k--) {
+        for (std::vector<sint16>::reverse_iterator it = w.rbegin();
+             it != w.rend(); it++) {
+            burau_multiply(m, n, *it, t, ti, true);
+        }
+    }
+
+    for (Braid::ConstFactorItr it = b.cbegin(); it != b.cend(); it++) {
+        w.clear();
+        append_word((*it).get_underlying(), w);
+        for (sint16 i : w) {
+            burau_multiply(m, n, i, t, ti, false);
+        }
+    }
+
+    uint64 trace = 0;
+    for (sint16 i = 0; i < n; i++) {
+        trace = (trace + m[i * n + i]) % BURAU_PRIME;
+    }
+    return trace;
+}
+
+void add_invariants(InvariantFilter<Braid> &filter) {
+    filter.add_invariant("exponent sum", exponent_sum);
+    filter.add_invariant("permutation cycle type",
+                         permutation_cycle_type<Factor>);
+    // Any point that is not a root of unity of small order will do.
+    filter.add_invariant("Burau trace",
+                         [](const Braid &b) { return burau_trace(b, 3); });
+}
+
+namespace {
+
+// Number of USS elements `thurston_type` tests before it turns to the class
+// cache.
+const sint32 THURSTON_PROBE = 256;
+
+// Whether some element of `b`'s USS preserves a family of circles. When
+// `budget` is non-negative, gives up (setting `exhausted`) after testing that
+// many elements.
+bool some_ultra_summit_preserves_circles(const Braid &b, sint32 budget,
+                                         bool &exhausted) {
+    exhausted = false;
+    bool none = ultra_summit::for_each_ultra_summit(
+        b, [&budget, &exhausted](const Braid &u) {
+            if (budget == 0) {
+                exhausted = true;
+                return false;
+            }
+            if (budget > 0) {
+                budget--;
+            }
+            return !preserves_circles(u);
+        });
+    return !none && !exhausted;
+}
+
+} // namespace
+
+// The USS is not built: its elements are tested as they are discovered, so
+// that we may stop at the first one that preserves a family of circles.
+// Periodicity is cheap to check, and so is reducibility when a reducing
+// element comes early, so that the class cache is only looked up (which
+// takes building the sliding circuits set) once the first `THURSTON_PROBE`
+// elements were tested in vain. The search then starts over if it misses.
 ThurstonType thurston_type(const Braid &b) {
-    return thurston_type(b, ultra_summit::ultra_summit_set(b));
+    Braid::Parameter n = b.get_parameter();
+
+    Braid pow = b;
+
+    for (sint16 i = 0; i < n; i++) {
+        if (pow.canonical_length() == 0)
+            return ThurstonType::Periodic;
+        pow.right_multiply(b);
+    }
+
+    ClassCache *cache = class_cache();
+    bool exhausted;
+    bool reducible = some_ultra_summit_preserves_circles(
+        b, cache == nullptr ? -1 : THURSTON_PROBE, exhausted);
+
+    if (!exhausted) {
+        return reducible ? ThurstonType::Reducible
+                         : ThurstonType::PseudoAsonov;
+    }
+
+    std::string key =
+        class_key('T', sliding_circuits::canonical_representative(b));
+    std::string bytes;
+    if (cache->find(key, bytes) && bytes.size() == 1) {
+        return ThurstonType(bytes[0]);
+    }
+
+    ThurstonType type = some_ultra_summit_preserves_circles(b, -1, exhausted)
+                            ? ThurstonType::Reducible
+                            : ThurstonType::PseudoAsonov;
+    cache->insert(key, std::string(1, char(type)));
+
+    return type;
 }
 
 } // namespace artin
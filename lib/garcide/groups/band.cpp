@@ -28,6 +28,7 @@
  */
 
 #include "garcide/groups/band.h"
+#include "garcide/permutation.h"
 
 namespace garcide::band {
 
@@ -37,26 +38,17 @@ sint16 Underlying::lattice_height() const { return get_parameter(); }
 
 Underlying::Parameter
 Underlying::parameter_of_string(const std::string &str) {
-    std::smatch match;
-
-    if (std::regex_match(str, match,
-                         std::regex{"[\\s\\t]*(" + number_regex + ")[\\s\\t]*"},
-                         std::regex_constants::match_continuous)) {
-        sint16 i;
-        try {
-            i = std::stoi(match[1]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Number of strands is too big!\n" +
-                                     match.str(1) +
-                                     " can not be converted to a C++ integer.");
-        }
+    StringSpan span;
+
+    if (match_whole_integer(str, span)) {
+        sint16 i = integer_of_string(str, span, "Number of strands");
         if (((2 <= i) && (i <= MAX_NUMBER_OF_STRANDS))) {
             return i;
         } else if (2 > i) {
             throw InvalidStringError("Number of strands should be at least 2!");
         } else {
             throw InvalidStringError("Number of strands is too big!\n" +
-                                     match.str(1) +
+                                     span.of(str) +
                                      " is strictly greater than " +
                                      std::to_string(MAX_NUMBER_OF_STRANDS) + ".");
         }
@@ -102,47 +94,29 @@ void Underlying::print(IndentedOStream &os) const {
 void Underlying::of_string(const std::string &str, size_t &pos) {
     sint16 n = get_parameter();
 
-    std::smatch match;
+    StringSpan first, second;
 
-    if (std::regex_search(str.begin() + pos, str.end(), match, std::regex{"D"},
-                          std::regex_constants::match_continuous)) {
-        pos += match[0].length();
+    if (match_char(str, pos, 'D')) {
         delta();
-    } else if (std::regex_search(str.begin() + pos, str.end(), match,
-                                 std::regex{"\\([\\s\\t]*(" + number_regex +
-                                            ")[\\s\\t]*,?[\\s\\t]*(" +
-                                            number_regex + ")[\\s\\t]*\\)"},
-                                 std::regex_constants::match_continuous)) {
-        pos += match[0].length();
-        sint16 i, j;
-        try {
-            i = std::stoi(match[1]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Index is too big!\n" + match.str(1) +
-                                     " can not be converted to a C++ integer.");
-        }
-        try {
-            j = std::stoi(match[2]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Index is too big!\n" + match.str(2) +
-                                     " can not be converted to a C++ integer.");
-        }
+    } else if (match_integer_pair(str, pos, first, second)) {
+        sint16 i = integer_of_string(str, first, "Index"),
+               j = integer_of_string(str, second, "Index");
         if ((i >= 1) && (i <= n) && (j >= 1) && (j <= n) && (i != j)) {
             identity();
             permutation_table[i] = j;
             permutation_table[j] = i;
         } else if ((i < 1) || (i > n)) {
             throw InvalidStringError("Invalid index for dual generator!\n" +
-                                     match.str(1) + " is not in [1, " +
+                                     first.of(str) + " is not in [1, " +
                                      std::to_string(n) + "].");
         } else if ((j < 1) || (j > n)) {
             throw InvalidStringError("Invalid index for dual generator!\n" +
-                                     match.str(2) + " is not in [1, " +
+                                     second.of(str) + " is not in [1, " +
                                      std::to_string(n) + "].");
         } else {
             throw InvalidStringError(
                 "Indexes for dual generators should not be equal!\n(" +
-                match.str(1) + ", " + match.str(2) +
+                first.of(str) + ", " + second.of(str) +
                 ") is not a valid factor.");
         }
     } else {
@@ -251,19 +225,15 @@ bool Underlying::compare(const Underlying &b) const {
 
 Underlying Underlying::inverse() const {
     Underlying f = Underlying(get_parameter());
-    sint16 i;
-    for (i = 1; i <= get_parameter(); i++) {
-        f.permutation_table[permutation_table[i]] = i;
-    }
+    permutation::invert(permutation_table.data(), f.permutation_table.data(),
+                        get_parameter() + 1);
     return f;
 };
 
 Underlying Underlying::product(const Underlying &b) const {
     Underlying f = Underlying(get_parameter());
-    sint16 i;
-    for (i = 1; i <= get_parameter(); i++) {
-        f.permutation_table[i] = b.permutation_table[permutation_table[i]];
-    }
+    permutation::compose(permutation_table.data(), b.permutation_table.data(),
+                         f.permutation_table.data(), get_parameter() + 1);
     return f;
 };
 
@@ -272,7 +242,12 @@ Underlying Underlying::left_complement(const Underlying &b) const {
 };
 
 Underlying Underlying::right_complement(const Underlying &b) const {
-    return inverse().product(b);
+    Underlying f = Underlying(get_parameter());
+    permutation::invert_then_compose(permutation_table.data(),
+                                     b.permutation_table.data(),
+                                     f.permutation_table.data(),
+                                     get_parameter() + 1);
+    return f;
 };
 
 void Underlying::delta_conjugate_mut(sint16 k) {
@@ -316,11 +291,23 @@ std::vector<Underlying> Underlying::atoms() const {
 }
 
 size_t Underlying::hash() const {
-    std::size_t h = 0;
+    return hash_bytes(permutation_table.data() + 1,
+                      get_parameter() * sizeof(Entry));
+}
+
+void Underlying::to_bytes(std::string &bytes) const {
     for (sint16 i = 1; i <= get_parameter(); i++) {
-        h = h * 31 + permutation_table[i];
+        bytes.push_back(char(permutation_table[i] - 1));
+    }
+}
+
+void Underlying::of_bytes(const std::string &bytes, size_t &pos) {
+    if (pos + get_parameter() > bytes.size()) {
+        throw InvalidStringError("Truncated factor!");
+    }
+    for (sint16 i = 1; i <= get_parameter(); i++) {
+        permutation_table[i] = Entry(uint8(bytes[pos++]) + 1);
     }
-    return h;
 }
 
 void Underlying::of_ballot_sequence(const sint8 *s) {
@@ -340,6 +327,38 @@ void Underlying::of_ballot_sequence(const sint8 *s) {
     }
 }
 
+sint32 exponent_sum(const Braid &b) {
+    Braid::Parameter n = b.get_parameter();
+
+    sint32 sum = sint32(b.inf()) * (n - 1);
+
+    // A factor is a product of disjoint descending cycles, and a cycle of
+    // length `l` is a product of `l - 1` generators: its length is `n` minus
+    // its number of cycles.
+    std::vector<bool> seen(n + 1);
+    for (Braid::ConstFactorItr it = b.cbegin(); it != b.cend(); it++) {
+        Underlying u = (*it).get_underlying();
+        sum += n;
+        std::fill(seen.begin(), seen.end(), false);
+        for (sint16 i = 1; i <= n; i++) {
+            if (!seen[i]) {
+                sum--;
+                for (sint16 j = i; !seen[j]; j = u.at(j)) {
+                    seen[j] = true;
+                }
+            }
+        }
+    }
+
+    return sum;
+}
+
+void add_invariants(InvariantFilter<Braid> &filter) {
+    filter.add_invariant("exponent sum", exponent_sum);
+    filter.add_invariant("permutation cycle type",
+                         permutation_cycle_type<Factor>);
+}
+
 #ifdef USE_CLN
 
 void ballot_sequence(sint16 n, cln::cl_I k, sint8 *s) {
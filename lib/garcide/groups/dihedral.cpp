@@ -37,18 +37,10 @@ sint16 Underlying::get_parameter() const { return number_of_points; }
 
 Underlying::Parameter
 Underlying::parameter_of_string(const std::string &str) {
-    std::smatch match;
-
-    if (std::regex_match(str, match,
-                         std::regex{"[\\s\\t]*(" + number_regex + ")[\\s\\t]*"},
-                         std::regex_constants::match_continuous)) {
-        sint16 i;
-        try {
-            i = std::stoi(match[1]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Parameter is too big!\n" + match.str(1) +
-                                     " can not be converted to a C++ integer.");
-        }
+    StringSpan span;
+
+    if (match_whole_integer(str, span)) {
+        sint16 i = integer_of_string(str, span, "Parameter");
         if (2 <= i) {
             return i;
         } else {
@@ -74,19 +66,17 @@ void Underlying::print(IndentedOStream &os) const {
 }
 
 void Underlying::of_string(const std::string &str, size_t &pos) {
-    std::smatch match;
+    StringSpan span;
+    size_t end = pos;
+    skip_whitespaces(str, end);
 
-    if (std::regex_search(str.begin() + pos, str.end(), match, std::regex{"D"},
-                          std::regex_constants::match_continuous)) {
-        pos += match[0].length();
+    if (match_char(str, pos, 'D')) {
         delta();
-    } else if (std::regex_search(str.begin() + pos, str.end(), match,
-                                 std::regex{"(s[\\s\\t]*_?)?[\\s\\t]*(" +
-                                            number_regex + ")"},
-                                 std::regex_constants::match_continuous)) {
-        point = Rem(std::stoi(match[2]), get_parameter());
+    } else if (match_subscripted(str, pos, 's', span) ||
+               match_integer(str, end, span)) {
+        pos = span.start + span.length;
+        point = Rem(integer_of_string(str, span, "Index"), get_parameter());
         type = 2;
-        pos += match[0].length();
     } else {
         throw InvalidStringError(std::string(
             "Could not extract a factor from\n\"" + str.substr(pos) +
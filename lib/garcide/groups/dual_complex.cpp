@@ -28,6 +28,7 @@
  */
 
 #include "garcide/groups/dual_complex.h"
+#include "garcide/permutation.h"
 
 namespace garcide {
 
@@ -41,28 +42,11 @@ EENParameter Underlying::get_parameter() const { return een_index; }
 
 Underlying::Parameter
 Underlying::parameter_of_string(const std::string &str) {
-    std::smatch match;
-
-    if (std::regex_match(str, match,
-                         std::regex{"[\\s\\t]*\\([\\s\\t]*(" + number_regex +
-                                    ")[\\s\\t]*,?[\\s\\t]*(" + number_regex +
-                                    ")[\\s\\t]*\\)[\\s\\t]*"},
-                         std::regex_constants::match_continuous)) {
-        sint16 e, n;
-        try {
-            e = std::stoi(match[1]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Parameter e is too big!\n" +
-                                     match.str(1) +
-                                     " can not be converted to a C++ integer.");
-        }
-        try {
-            n = std::stoi(match[2]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Parameter n is too big!\n" +
-                                     match.str(2) +
-                                     " can not be converted to a C++ integer.");
-        }
+    StringSpan first, second;
+
+    if (match_whole_integer_pair(str, first, second)) {
+        sint16 e = integer_of_string(str, first, "Parameter e"),
+               n = integer_of_string(str, second, "Parameter n");
         if ((2 <= e) && (2 <= n) && (n <= MAX_N) && (e * n <= MAX_E * MAX_N)) {
             return EENParameter(e, n);
         } else if (2 > e) {
@@ -71,12 +55,12 @@ Underlying::parameter_of_string(const std::string &str) {
             throw InvalidStringError("n should be at least 2!");
         } else if (n > MAX_N) {
             throw InvalidStringError("n is too big!\n" +
-                                     match.str(1) +
+                                     second.of(str) +
                                      " is strictly greater than " +
                                      std::to_string(MAX_N) + ".");
         } else {
             throw InvalidStringError("e * n is too big!\n" +
-                                     match.str(1) + " * " + match.str(2) + " = " + std::to_string(e * n) +
+                                     first.of(str) + " * " + second.of(str) + " = " + std::to_string(e * n) +
                                      " is strictly greater than " +
                                      std::to_string(MAX_N * MAX_E) + ".");
         }
@@ -236,20 +220,12 @@ void Underlying::print(IndentedOStream &os) const {
 
 void Underlying::of_string(const std::string &str, size_t &pos) {
     sint16 n = get_parameter().n, e = get_parameter().e;
-    std::smatch match;
-    if (std::regex_search(str.begin() + pos, str.end(), match,
-                                 std::regex{"D"},
-                                 std::regex_constants::match_continuous)) {
-        pos += match[0].length();
+    StringSpan first, second;
+    if (match_char(str, pos, 'D')) {
         delta();
-    } else if (std::regex_search(str.begin() + pos, str.end(), match,
-                          std::regex{"\\([\\s\\t]*(" + number_regex +
-                                     ")[\\s\\t]*,?[\\s\\t]*(" + number_regex +
-                                     ")[\\s\\t]*\\)"},
-                          std::regex_constants::match_continuous)) {
-        sint16 i = std::stoi(match[1]);
-        sint16 j = std::stoi(match[2]);
-        pos += match[0].length();
+    } else if (match_integer_pair(str, pos, first, second)) {
+        sint16 i = integer_of_string(str, first, "Index");
+        sint16 j = integer_of_string(str, second, "Index");
         i = Rem(i - 1, e * n) + 1;
         j = Rem(j - 1, e * n) + 1;
         if (i > j) {
@@ -273,23 +249,17 @@ void Underlying::of_string(const std::string &str, size_t &pos) {
             throw InvalidStringError("Indexes for short symmetric generators "
                                      "should not be equal mod " +
                                      std::to_string(e * n) + "!\n(" +
-                                     std::to_string(std::stoi(match[1])) +
-                                     ", " +
-                                     std::to_string(std::stoi(match[2])) +
+                                     first.of(str) + ", " + second.of(str) +
                                      ") is not a valid factor.");
         } else {
             throw InvalidStringError(
                 "Indexes for short generators should be at most " +
                 std::to_string(n - 1) + " apart mod" + std::to_string(e * n) +
-                "!\n(" + std::to_string(std::stoi(match[1])) + ", " +
-                std::to_string(std::stoi(match[2])) +
+                "!\n(" + first.of(str) + ", " + second.of(str) +
                 ") is not a valid factor.");
         }
-    } else if (std::regex_search(str.begin() + pos, str.end(), match,
-                                 std::regex{"(" + number_regex + ")"},
-                                 std::regex_constants::match_continuous)) {
-        sint16 i = std::stoi(match[1]);
-        pos += match[0].length();
+    } else if (match_integer(str, pos, first)) {
+        sint16 i = integer_of_string(str, first, "Index");
         i = Rem(i - 1, e * n) + 1;
         sint16 q = Rem(Quot(i - 1, n), e);
         sint16 r = Rem(i - 1, n) + 1;
@@ -609,10 +579,14 @@ Underlying Underlying::inverse() const {
 Underlying Underlying::product(const Underlying &b) const {
     Underlying f = Underlying(get_parameter());
     sint16 i, n = get_parameter().n, e = get_parameter().e;
+    // Coefficients are moved along the permutation, like its images.
+    permutation::compose(permutation_table.data(), b.permutation_table.data(),
+                         f.permutation_table.data(), n + 1);
+    permutation::compose(permutation_table.data(), b.coefficient_table.data(),
+                         f.coefficient_table.data(), n + 1);
     for (i = 0; i <= n; i++) {
-        f.permutation_table[i] = b.permutation_table[permutation_table[i]];
-        f.coefficient_table[i] = Rem(
-            b.coefficient_table[permutation_table[i]] + coefficient_table[i], e);
+        f.coefficient_table[i] =
+            Rem(f.coefficient_table[i] + coefficient_table[i], e);
     }
     return f;
 };
@@ -692,14 +666,9 @@ std::vector<Underlying> Underlying::atoms() const {
 }
 
 std::size_t Underlying::hash() const {
-    std::size_t h = 0;
-    for (sint16 i = 1; i <= get_parameter().n; i++) {
-        h = h * 31 + permutation_table[i];
-    }
-    for (sint16 i = 1; i <= get_parameter().n; i++) {
-        h = h * 31 + coefficient_table[i];
-    }
-    return h;
+    std::size_t length = (get_parameter().n + 1) * sizeof(sint16);
+    return hash_combine(hash_bytes(permutation_table.data(), length),
+                        hash_bytes(coefficient_table.data(), length));
 }
 
 } // namespace dual_complex
@@ -15,19 +15,14 @@
 namespace garcide::euclidean_lattice {
 
 Underlying::Parameter Underlying::parameter_of_string(const std::string &str) {
-    std::smatch match;
+    StringSpan span;
 
-    if (std::regex_match(str, match,
-                         std::regex{"[\\s\\t]*([1-9][0-9]*)[\\s\\t]*"})) {
+    if (match_whole_integer(str, span) && str[span.start] != '-' &&
+        str[span.start] != '0') {
         // Try to match str with a strictly positive integer.
-        try {
-            return std::stoull(match[1]);
-        } catch (std::out_of_range const &) {
-            // Even if str matches a positive integer, it might be too big for
-            // C++.
-            throw InvalidStringError("Dimension is too big!\n" + match.str(1) +
-                                     " cannot be converted to a C++ integer.");
-        }
+        // Even if str matches a positive integer, it might be too big for
+        // C++.
+        return integer_of_string<Parameter>(str, span, "Dimension");
     } else {
         // Otherwise fail and explain why.
         throw InvalidStringError(std::string(
@@ -45,34 +40,25 @@ Underlying::Underlying(Underlying::Parameter n) : coordinates(n, false) {}
 void Underlying::of_string(const std::string &str, size_t &pos) {
     Parameter n = get_parameter();
 
-    std::smatch match;
-
-    if (std::regex_search(
-            str.begin() + pos, str.end(), match,
-            std::regex{"(?:e[\\s\\t]*_?[\\s\\t]*)?(" + number_regex + ")"},
-            std::regex_constants::match_continuous)) {
-        // Try to extract a substring starting at pos that matches the regex.
-        sint16 i;
-        try {
-            i = std::stoi(match[1]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Index is too big!\n" + match.str(1) +
-                                     " cannot be converted to a C++ integer.");
-        }
-        pos += match[0].length();
+    StringSpan span;
+    size_t end = pos;
+
+    if (match_subscripted(str, pos, 'e', span) ||
+        match_integer(str, end, span)) {
+        // Try to extract a substring starting at pos that matches
+        // ('e' '_'?)? Z.
+        pos = span.start + span.length;
+        sint16 i = integer_of_string(str, span, "Index");
         if ((i >= 0) && (i < int(n))) {
             identity();
             coordinates[i] = true;
         } else {
             throw InvalidStringError(
-                "Invalid index for canonical base vector!\n" + match.str(1) +
+                "Invalid index for canonical base vector!\n" + span.of(str) +
                 " is not in [0, " + std::to_string(n) + "[.");
         }
-    } else if (std::regex_search(str.begin() + pos, str.end(), match,
-                                 std::regex{"D"},
-                                 std::regex_constants::match_continuous)) {
+    } else if (match_char(str, pos, 'D')) {
         // Else try to match "D".
-        pos += match[0].length();
         delta();
     } else {
         // Otherwise fail.
@@ -155,12 +141,15 @@ std::vector<Underlying> Underlying::atoms() const {
 }
 
 size_t Underlying::hash() const {
-    size_t hash = 0;
+    uint64 hash = hash_mix(get_parameter()), word = 0;
     for (size_t i = 0; i < get_parameter(); i++) {
-        hash <<= 1;
-        hash += (at(i) ? 1 : 0);
+        word = (word << 1) | (at(i) ? 1 : 0);
+        if (i % 64 == 63) {
+            hash = hash_combine(hash, word);
+            word = 0;
+        }
     }
-    return hash;
+    return hash_combine(hash, word);
 }
 
 } // namespace garcide::euclidean_lattice
\ No newline at end of file
@@ -28,6 +28,7 @@
  */
 
 #include "garcide/groups/octahedral.h"
+#include "garcide/permutation.h"
 
 namespace garcide::octahedral {
 
@@ -46,25 +47,17 @@ const sint16 MaxBraidIndex = 256;
 
 Underlying::Parameter
 Underlying::parameter_of_string(const std::string &str) {
-    std::smatch match;
-
-    if (std::regex_match(str, match,
-                         std::regex{"[\\s\\t]*(" + number_regex + ")[\\s\\t]*"},
-                         std::regex_constants::match_continuous)) {
-        sint16 i;
-        try {
-            i = std::stoi(match[1]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Parameter is too big!\n" + match.str(1) +
-                                     " can not be converted to a C++ integer.");
-        }
+    StringSpan span;
+
+    if (match_whole_integer(str, span)) {
+        sint16 i = integer_of_string(str, span, "Parameter");
         if (((1 <= i) && (i <= MaxBraidIndex))) {
             return i;
         } else if (1 > i) {
             throw InvalidStringError("Parameter should be at least 1!");
         } else {
             throw InvalidStringError("Parameter strands is too big!\n" +
-                                     match.str(1) +
+                                     span.of(str) +
                                      " is strictly greater than " +
                                      std::to_string(MaxBraidIndex) + ".");
         }
@@ -142,32 +135,14 @@ void Underlying::debug(IndentedOStream &os) const {
 
 void Underlying::of_string(const std::string &str, size_t &pos) {
     sint16 n = get_parameter();
-    std::smatch match;
-    if (std::regex_search(str.begin() + pos, str.end(), match, std::regex{"D"},
-                          std::regex_constants::match_continuous)) {
-        pos += match[0].length();
+    StringSpan first, second;
+    if (match_char(str, pos, 'D')) {
         delta();
-    } else if (std::regex_search(str.begin() + pos, str.end(), match,
-                                 std::regex{"\\([\\s\\t]*(" + number_regex +
-                                            ")[\\s\\t]*,?[\\s\\t]*(" +
-                                            number_regex + ")[\\s\\t]*\\)"},
-                                 std::regex_constants::match_continuous)) {
-        sint16 i, j;
-        try {
-            i = std::stoi(match[1]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Index is too big!\n" + match.str(1) +
-                                     " can not be converted to a C++ integer.");
-        }
-        try {
-            j = std::stoi(match[2]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Index is too big!\n" + match.str(2) +
-                                     " can not be converted to a C++ integer.");
-        }
+    } else if (match_integer_pair(str, pos, first, second)) {
+        sint16 i = integer_of_string(str, first, "Index"),
+               j = integer_of_string(str, second, "Index");
         i = Rem(i - 1, 2 * n) + 1;
         j = Rem(j - 1, 2 * n) + 1;
-        pos += match[0].length();
         if ((i != j) && (i != Rem(j + n - 1, 2 * n) + 1)) {
             identity();
             permutation_table[i] = j;
@@ -179,21 +154,12 @@ void Underlying::of_string(const std::string &str, size_t &pos) {
         } else {
             throw InvalidStringError(
                 "Indexes for short generators should not be equal mod " +
-                std::to_string(n) + "!\n(" + match.str(1) + ", " +
-                match.str(2) + ") is not a valid factor.");
-        }
-    } else if (std::regex_search(str.begin() + pos, str.end(), match,
-                                 std::regex{"(" + number_regex + ")"},
-                                 std::regex_constants::match_continuous)) {
-        sint16 i;
-        try {
-            i = std::stoi(match[1]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Index is too big!\n" + match.str(1) +
-                                     " can not be converted to a C++ integer.");
+                std::to_string(n) + "!\n(" + first.of(str) + ", " +
+                second.of(str) + ") is not a valid factor.");
         }
+    } else if (match_integer(str, pos, first)) {
+        sint16 i = integer_of_string(str, first, "Index");
         i = Rem(i - 1, 2 * n) + 1;
-        pos += match[0].length();
         identity();
         permutation_table[i] = Rem(i + n - 1, 2 * n) + 1;
         permutation_table[Rem(i + n - 1, 2 * n) + 1] = i;
@@ -281,19 +247,15 @@ bool Underlying::compare(const Underlying &b) const {
 
 Underlying Underlying::inverse() const {
     Underlying f = Underlying(get_parameter());
-    sint16 i;
-    for (i = 1; i <= 2 * get_parameter(); i++) {
-        f.permutation_table[permutation_table[i]] = i;
-    }
+    permutation::invert(permutation_table.data(), f.permutation_table.data(),
+                        2 * get_parameter() + 1);
     return f;
 };
 
 Underlying Underlying::product(const Underlying &b) const {
     Underlying f = Underlying(get_parameter());
-    sint16 i;
-    for (i = 1; i <= 2 * get_parameter(); i++) {
-        f.permutation_table[i] = b.permutation_table[permutation_table[i]];
-    }
+    permutation::compose(permutation_table.data(), b.permutation_table.data(),
+                         f.permutation_table.data(), 2 * get_parameter() + 1);
     return f;
 };
 
@@ -302,7 +264,12 @@ Underlying Underlying::left_complement(const Underlying &b) const {
 };
 
 Underlying Underlying::right_complement(const Underlying &b) const {
-    return inverse().product(b);
+    Underlying f = Underlying(get_parameter());
+    permutation::invert_then_compose(permutation_table.data(),
+                                     b.permutation_table.data(),
+                                     f.permutation_table.data(),
+                                     2 * get_parameter() + 1);
+    return f;
 };
 
 void Underlying::delta_conjugate_mut(sint16 k) {
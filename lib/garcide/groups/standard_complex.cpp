@@ -74,28 +74,11 @@ EENParameter Underlying::get_parameter() const { return een_index; }
 
 Underlying::Parameter
 Underlying::parameter_of_string(const std::string &str) {
-    std::smatch match;
-
-    if (std::regex_match(str, match,
-                         std::regex{"[\\s\\t]*\\([\\s\\t]*(" + number_regex +
-                                    ")[\\s\\t]*,?[\\s\\t]*(" + number_regex +
-                                    ")[\\s\\t]*\\)[\\s\\t]*"},
-                         std::regex_constants::match_continuous)) {
-        sint16 e, n;
-        try {
-            e = std::stoi(match[1]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Parameter e is too big!\n" +
-                                     match.str(1) +
-                                     " can not be converted to a C++ integer.");
-        }
-        try {
-            n = std::stoi(match[2]);
-        } catch (std::out_of_range const &) {
-            throw InvalidStringError("Parameter n is too big!\n" +
-                                     match.str(2) +
-                                     " can not be converted to a C++ integer.");
-        }
+    StringSpan first, second;
+
+    if (match_whole_integer_pair(str, first, second)) {
+        sint16 e = integer_of_string(str, first, "Parameter e"),
+               n = integer_of_string(str, second, "Parameter n");
         if ((2 <= e) && (2 <= n) && (n <= MAX_N)) {
             return EENParameter(e, n);
         } else if (2 > e) {
@@ -103,7 +86,7 @@ Underlying::parameter_of_string(const std::string &str) {
         } else if (2 > n) {
             throw InvalidStringError("n should be at least 2!");
         } else {
-            throw InvalidStringError("n is too big!\n" + match.str(1) +
+            throw InvalidStringError("n is too big!\n" + second.of(str) +
                                      " is strictly greater than " +
                                      std::to_string(MAX_N) + ".");
         }
@@ -185,18 +168,14 @@ void Underlying::print(IndentedOStream &os) const {
 
 void Underlying::of_string(const std::string &str, size_t &pos) {
     sint16 n = get_parameter().n, e = get_parameter().e;
-    std::smatch match;
-    if (std::regex_search(str.begin() + pos, str.end(), match, std::regex{"D"},
-                          std::regex_constants::match_continuous)) {
-        pos += match[0].length();
+    size_t start = pos;
+    StringSpan span;
+    if (match_char(str, pos, 'D')) {
         delta();
-    } else if (std::regex_search(str.begin() + pos, str.end(), match,
-                                 std::regex{"([st])[\\s\\t]*_?[\\s\\t]*(" +
-                                            number_regex + ")"},
-                                 std::regex_constants::match_continuous)) {
-        sint16 i = std::stoi(match[2]);
-        pos += match[0].length();
-        if (match[1] == "s") {
+    } else if (match_subscripted(str, pos, 's', span) ||
+               match_subscripted(str, pos, 't', span)) {
+        sint16 i = integer_of_string(str, span, "Index");
+        if (str[start] == 's') {
             if ((3 <= i) && (i <= n)) {
                 // s_i.
                 identity();
@@ -0,0 +1,302 @@
+/**
+ * @file permutation.cpp
+ * @author Matteo Wei (matteo.wei@ens.psl.eu)
+ * @brief Implementation file for permutation table kernels.
+ * @version 0.1
+ * @date 2024-07-28
+ *
+ * @copyright Copyright (C) 2024. Distributed under the GNU General Public
+ * License, version 3.
+ *
+ */
+
+/*
+ * GarCide Copyright (C) 2024 Matteo Wei.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License in LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "garcide/permutation.h"
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PERMUTATION_X86
+#include <immintrin.h>
+#endif
+
+namespace garcide::permutation {
+
+namespace {
+
+enum class InstructionSet { Scalar, SSE41, AVX2, AVX512 };
+
+const char *const instruction_set_names[] = {"scalar", "sse4.1", "avx2",
+                                             "avx512"};
+
+template <class T>
+void compose_scalar(const T *a, const T *b, T *r, std::size_t size) {
+    for (std::size_t i = 0; i < size; i++) {
+        r[i] = b[a[i]];
+    }
+}
+
+std::uint64_t compose_nibbles_scalar(std::uint64_t a, std::uint64_t b) {
+    std::uint64_t r = 0;
+    for (std::uint64_t i = 0; i < 64; i += 4) {
+        r |= ((b >> (4 * ((a >> i) & 0xF))) & 0xF) << i;
+    }
+    return r;
+}
+
+#ifdef PERMUTATION_X86
+
+// Spreads the 16 nibbles of `a` over the 16 bytes of a register.
+__attribute__((target("sse4.1"))) inline __m128i
+unpack_nibbles_sse41(std::uint64_t a) {
+    __m128i x = _mm_cvtsi64_si128((long long)a), low = _mm_set1_epi8(0xF);
+    return _mm_unpacklo_epi8(_mm_and_si128(x, low),
+                             _mm_and_si128(_mm_srli_epi16(x, 4), low));
+}
+
+__attribute__((target("sse4.1"))) std::uint64_t
+compose_nibbles_sse41(std::uint64_t a, std::uint64_t b) {
+    __m128i r8 =
+        _mm_shuffle_epi8(unpack_nibbles_sse41(b), unpack_nibbles_sse41(a));
+    // Bytes `2 * i` and `2 * i + 1` are merged into one.
+    __m128i r16 = _mm_maddubs_epi16(r8, _mm_set1_epi16(0x1001));
+    return (std::uint64_t)_mm_cvtsi128_si64(_mm_packus_epi16(r16, r16));
+}
+
+// Narrows 16 entries to bytes. Out of range values (which may only come from
+// padding) saturate to 255, which `pshufb` maps to 0.
+__attribute__((target("sse4.1"))) inline __m128i
+load_bytes_sse41(const std::uint16_t *p) {
+    return _mm_packus_epi16(_mm_loadu_si128((const __m128i *)p),
+                            _mm_loadu_si128((const __m128i *)(p + 8)));
+}
+
+// Tables with at most 16 entries fit in one register once narrowed to bytes,
+// and then composition is a single `pshufb`.
+__attribute__((target("sse4.1"))) void
+compose_sse41(const std::uint16_t *a, const std::uint16_t *b,
+              std::uint16_t *r, std::size_t size) {
+    if (size > 16) {
+        compose_scalar(a, b, r, size);
+        return;
+    }
+    __m128i r8 = _mm_shuffle_epi8(load_bytes_sse41(b), load_bytes_sse41(a));
+    _mm_storeu_si128((__m128i *)r, _mm_cvtepu8_epi16(r8));
+    _mm_storeu_si128((__m128i *)(r + 8),
+                     _mm_cvtepu8_epi16(_mm_srli_si128(r8, 8)));
+}
+
+// Narrows 32 entries to bytes, in order.
+__attribute__((target("avx2"))) inline __m256i
+load_bytes_avx2(const std::uint16_t *p) {
+    __m256i x =
+        _mm256_packus_epi16(_mm256_loadu_si256((const __m256i *)p),
+                            _mm256_loadu_si256((const __m256i *)(p + 16)));
+    // `packus` works within 128-bit lanes.
+    return _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+// `vpshufb` does not cross 128-bit lanes, so for up to 32 entries we shuffle
+// both halves of `b` and blend according to the high bit of the index.
+__attribute__((target("avx2"))) void
+compose_avx2(const std::uint16_t *a, const std::uint16_t *b, std::uint16_t *r,
+             std::size_t size) {
+    if (size <= 16) {
+        compose_sse41(a, b, r, size);
+        return;
+    }
+    if (size > 32) {
+        compose_scalar(a, b, r, size);
+        return;
+    }
+    __m256i a8 = load_bytes_avx2(a), b8 = load_bytes_avx2(b);
+    __m256i low = _mm256_shuffle_epi8(_mm256_permute2x128_si256(b8, b8, 0x00),
+                                      a8),
+            high = _mm256_shuffle_epi8(
+                _mm256_permute2x128_si256(b8, b8, 0x11), a8);
+    __m256i r8 = _mm256_blendv_epi8(
+        low, high, _mm256_cmpgt_epi8(a8, _mm256_set1_epi8(15)));
+    _mm256_storeu_si256((__m256i *)r,
+                        _mm256_cvtepu8_epi16(_mm256_castsi256_si128(r8)));
+    _mm256_storeu_si256((__m256i *)(r + 16),
+                        _mm256_cvtepu8_epi16(_mm256_extracti128_si256(r8, 1)));
+}
+
+// Masked loads and stores make padding unnecessary.
+__attribute__((target("avx512f,avx512bw"))) void
+compose_avx512(const std::uint16_t *a, const std::uint16_t *b,
+               std::uint16_t *r, std::size_t size) {
+    if (size > 64) {
+        compose_scalar(a, b, r, size);
+        return;
+    }
+    __mmask32 low_mask = size >= 32 ? ~__mmask32(0)
+                                    : (__mmask32(1) << size) - 1,
+              high_mask = size <= 32   ? 0
+                          : size >= 64 ? ~__mmask32(0)
+                                       : (__mmask32(1) << (size - 32)) - 1;
+    __m512i b_low = _mm512_maskz_loadu_epi16(low_mask, b),
+            a_low = _mm512_maskz_loadu_epi16(low_mask, a);
+    if (size <= 32) {
+        _mm512_mask_storeu_epi16(r, low_mask,
+                                 _mm512_permutexvar_epi16(a_low, b_low));
+        return;
+    }
+    __m512i b_high = _mm512_maskz_loadu_epi16(high_mask, b + 32),
+            a_high = _mm512_maskz_loadu_epi16(high_mask, a + 32);
+    _mm512_mask_storeu_epi16(r, low_mask,
+                             _mm512_permutex2var_epi16(b_low, a_low, b_high));
+    _mm512_mask_storeu_epi16(r + 32, high_mask,
+                             _mm512_permutex2var_epi16(b_low, a_high, b_high));
+}
+
+// There is no 32-bit shuffle in SSE4.1 that is worth the narrowing.
+void compose_sse41(const sint16 *a, const sint16 *b, sint16 *r,
+                   std::size_t size) {
+    compose_scalar(a, b, r, size);
+}
+
+__attribute__((target("avx2"))) void compose_avx2(const sint16 *a,
+                                                  const sint16 *b, sint16 *r,
+                                                  std::size_t size) {
+    if (size > 8) {
+        compose_scalar(a, b, r, size);
+        return;
+    }
+    __m256i mask =
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(int(size)),
+                           _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i va = _mm256_maskload_epi32(a, mask),
+            vb = _mm256_maskload_epi32(b, mask);
+    _mm256_maskstore_epi32(r, mask, _mm256_permutevar8x32_epi32(vb, va));
+}
+
+__attribute__((target("avx512f"))) void compose_avx512(const sint16 *a,
+                                                       const sint16 *b,
+                                                       sint16 *r,
+                                                       std::size_t size) {
+    if (size > 32) {
+        compose_scalar(a, b, r, size);
+        return;
+    }
+    __mmask16 low_mask = size >= 16 ? ~__mmask16(0)
+                                    : __mmask16((1u << size) - 1),
+              high_mask = size <= 16   ? 0
+                          : size >= 32 ? ~__mmask16(0)
+                                       : __mmask16((1u << (size - 16)) - 1);
+    __m512i b_low = _mm512_maskz_loadu_epi32(low_mask, b),
+            a_low = _mm512_maskz_loadu_epi32(low_mask, a);
+    if (size <= 16) {
+        _mm512_mask_storeu_epi32(r, low_mask,
+                                 _mm512_permutexvar_epi32(a_low, b_low));
+        return;
+    }
+    __m512i b_high = _mm512_maskz_loadu_epi32(high_mask, b + 16),
+            a_high = _mm512_maskz_loadu_epi32(high_mask, a + 16);
+    _mm512_mask_storeu_epi32(r, low_mask,
+                             _mm512_permutex2var_epi32(b_low, a_low, b_high));
+    _mm512_mask_storeu_epi32(r + 16, high_mask,
+                             _mm512_permutex2var_epi32(b_low, a_high, b_high));
+}
+
+#endif
+
+InstructionSet detect_instruction_set() {
+    InstructionSet best = InstructionSet::Scalar;
+#ifdef PERMUTATION_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512bw")) {
+        best = InstructionSet::AVX512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        best = InstructionSet::AVX2;
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        best = InstructionSet::SSE41;
+    }
+#endif
+    const char *cap = std::getenv("GARCIDE_PERMUTATION_KERNELS");
+    if (cap != nullptr) {
+        for (sint16 i = 0; i <= sint16(best); i++) {
+            if (std::strcmp(cap, instruction_set_names[i]) == 0) {
+                return InstructionSet(i);
+            }
+        }
+    }
+    return best;
+}
+
+InstructionSet selected_instruction_set() {
+    static const InstructionSet set = detect_instruction_set();
+    return set;
+}
+
+template <class T>
+using ComposeKernel = void (*)(const T *, const T *, T *, std::size_t);
+
+template <class T> ComposeKernel<T> select_compose() {
+#ifdef PERMUTATION_X86
+    switch (selected_instruction_set()) {
+    case InstructionSet::AVX512:
+        return compose_avx512;
+    case InstructionSet::AVX2:
+        return compose_avx2;
+    case InstructionSet::SSE41:
+        return compose_sse41;
+    default:
+        break;
+    }
+#endif
+    return compose_scalar<T>;
+}
+
+using ComposeNibblesKernel = std::uint64_t (*)(std::uint64_t, std::uint64_t);
+
+ComposeNibblesKernel select_compose_nibbles() {
+#ifdef PERMUTATION_X86
+    if (selected_instruction_set() != InstructionSet::Scalar) {
+        return compose_nibbles_sse41;
+    }
+#endif
+    return compose_nibbles_scalar;
+}
+
+} // namespace
+
+void compose(const std::uint16_t *a, const std::uint16_t *b, std::uint16_t *r,
+             std::size_t size) {
+    static const ComposeKernel<std::uint16_t> kernel =
+        select_compose<std::uint16_t>();
+    kernel(a, b, r, size);
+}
+
+void compose(const sint16 *a, const sint16 *b, sint16 *r, std::size_t size) {
+    static const ComposeKernel<sint16> kernel = select_compose<sint16>();
+    kernel(a, b, r, size);
+}
+
+std::uint64_t compose_nibbles(std::uint64_t a, std::uint64_t b) {
+    static const ComposeNibblesKernel kernel = select_compose_nibbles();
+    return kernel(a, b);
+}
+
+const char *instruction_set() {
+    return instruction_set_names[sint16(selected_instruction_set())];
+}
+
+} // namespace garcide::permutation
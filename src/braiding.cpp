@@ -33,13 +33,32 @@
 
 namespace braiding {
 
+bool is_command(const std::string &str, const char *command) {
+    size_t pos = 0;
+    garcide::skip_whitespaces(str, pos);
+    for (; *command != '\0'; command++, pos++) {
+        if (pos == str.length()) {
+            return false;
+        }
+        char c = str[pos];
+        if (*command >= 'A' && *command <= 'Z' && c >= 'a' && c <= 'z') {
+            c = c - 'a' + 'A';
+        }
+        if (c != *command) {
+            return false;
+        }
+    }
+    garcide::skip_whitespaces(str, pos);
+    return pos == str.length();
+}
+
 void read_braid(Braid &b, std::istream &is) {
     std::string str;
     std::getline(is, str);
-    if (std::regex_match(str, std::regex{"[\\s\\t]*\\?[\\s\\t]*"})) {
+    if (is_command(str, "?")) {
         throw HelpAskedFor();
     }
-    if (std::regex_match(str, std::regex{"[\\s\\t]*[qQ][\\s\\t]*"})) {
+    if (is_command(str, "Q")) {
         throw InterruptAskedFor();
     }
     b.of_string(str);
@@ -48,10 +67,10 @@ void read_braid(Braid &b, std::istream &is) {
 Braid::Parameter read_braid_parameter(std::istream &is) {
     std::string str;
     std::getline(is, str);
-    if (std::regex_match(str, std::regex{"[\\s\\t]*\\?[\\s\\t]*"})) {
+    if (is_command(str, "?")) {
         throw HelpAskedFor();
     }
-    if (std::regex_match(str, std::regex{"[\\s\\t]*[qQ][\\s\\t]*"})) {
+    if (is_command(str, "Q")) {
         throw InterruptAskedFor();
     }
     return Braid::parameter_of_string(str);
@@ -447,51 +466,37 @@ Option prompt_option() {
         ind_cout << "Choose an option (? for help):" << EndLine(1) << ">>> ";
         std::string str;
         std::getline(std::cin, str);
-        if (std::regex_match(str, std::regex{"[\\s\\t]*\\?[\\s\\t]*"})) {
+        if (is_command(str, "?")) {
             ind_cout << EndLine();
             print_options();
-        } else if (std::regex_match(str,
-                                    std::regex{"[\\s\\t]*[lL][\\s\\t]*"})) {
+        } else if (is_command(str, "L")) {
             return Option::LCF;
-        } else if (std::regex_match(str,
-                                    std::regex{"[\\s\\t]*[rR][\\s\\t]*"})) {
+        } else if (is_command(str, "R")) {
             return Option::RCF;
-        } else if (std::regex_match(str,
-                                    std::regex{"[\\s\\t]*\\^[lL][\\s\\t]*"})) {
+        } else if (is_command(str, "^L")) {
             return Option::LGCD;
-        } else if (std::regex_match(str,
-                                    std::regex{"[\\s\\t]*\\^[rR][\\s\\t]*"})) {
+        } else if (is_command(str, "^R")) {
             return Option::RGCD;
-        } else if (std::regex_match(str,
-                                    std::regex{"[\\s\\t]*v[lL][\\s\\t]*"})) {
+        } else if (is_command(str, "vL")) {
             return Option::LLCM;
-        } else if (std::regex_match(str,
-                                    std::regex{"[\\s\\t]*v[rR][\\s\\t]*"})) {
+        } else if (is_command(str, "vR")) {
             return Option::RLCM;
-        } else if (std::regex_match(
-                       str, std::regex{"[\\s\\t]*[sS][sS][sS][\\s\\t]*"})) {
+        } else if (is_command(str, "SSS")) {
             return Option::SSS;
-        } else if (std::regex_match(
-                       str, std::regex{"[\\s\\t]*[uU][sS][sS][\\s\\t]*"})) {
+        } else if (is_command(str, "USS")) {
             return Option::USS;
-        } else if (std::regex_match(
-                       str, std::regex{"[\\s\\t]*[sS][cC][sS][\\s\\t]*"})) {
+        } else if (is_command(str, "SCS")) {
             return Option::SCS;
-        } else if (std::regex_match(
-                       str, std::regex{"[\\s\\t]*[cC][tT][rR][\\s\\t]*"})) {
+        } else if (is_command(str, "CTR")) {
             return Option::Centralizer;
-        } else if (std::regex_match(str,
-                                    std::regex{"[\\s\\t]*[cC][\\s\\t]*"})) {
+        } else if (is_command(str, "C")) {
             return Option::Conjugacy;
-        } else if (std::regex_match(str,
-                                    std::regex{"[\\s\\t]*[qQ][\\s\\t]*"})) {
+        } else if (is_command(str, "Q")) {
             return Option::Quit;
-        } else if (std::regex_match(str,
-                                    std::regex{"[\\s\\t]*[hH][\\s\\t]*"})) {
+        } else if (is_command(str, "H")) {
             return Option::Header;
 #if BRAIDING_CLASS == 0
-        } else if (std::regex_match(str,
-                                    std::regex{"[\\s\\t]*[tT][\\s\\t]*"})) {
+        } else if (is_command(str, "T")) {
             return Option::ThurstonType;
 #endif
         } else {
@@ -561,7 +566,11 @@ void sss_case() {
     Braid b(prompt_braid_parameter());
     prompt_braid(b);
     ind_cout << EndLine();
-    garcide::super_summit::super_summit_set(b).print(ind_cout);
+    dispatch(
+        [](const auto &b) {
+            garcide::super_summit::super_summit_set(b).print(ind_cout);
+        },
+        b);
     ind_cout << EndLine(1);
 }
 
@@ -569,35 +578,54 @@ void uss_case() {
     Braid b(prompt_braid_parameter());
     prompt_braid(b);
     ind_cout << EndLine();
-    garcide::ultra_summit::ultra_summit_set(b).print();
+    dispatch(
+        [](const auto &b) {
+            garcide::ultra_summit::ultra_summit_set(b).print();
+        },
+        b);
 }
 
 void scs_case() {
     Braid b(prompt_braid_parameter());
     prompt_braid(b);
     ind_cout << EndLine();
-    garcide::sliding_circuits::sliding_circuits_set(b).print();
+    dispatch(
+        [](const auto &b) {
+            garcide::sliding_circuits::sliding_circuits_set(b).print();
+        },
+        b);
 }
 
 void centralizer_case() {
     Braid b(prompt_braid_parameter());
     prompt_braid(b);
     ind_cout << EndLine();
-    garcide::centralizer::centralizer(b).print();
+    dispatch([](const auto &b) { garcide::centralizer::centralizer(b).print(); },
+             b);
 }
 
 void conjugacy_case() {
     Braid::Parameter p = prompt_braid_parameter();
-    Braid b(p), c(p), conj(p);
+    Braid b(p), c(p);
     prompt_braid(b);
     prompt_braid(c);
-    if (garcide::sliding_circuits::are_conjugate(b, c, conj)) {
-        ind_cout << EndLine() << "They are conjugates." << EndLine()
-                 << "A conjugating element is:" << EndLine() << conj
-                 << EndLine(1);
-    } else {
-        ind_cout << EndLine() << "They are not conjugates.";
-    }
+    dispatch(
+        [](const auto &b, const auto &c) {
+            using B = typename std::decay<decltype(b)>::type;
+            B conj(b.get_parameter());
+            std::string decided_by;
+            if (garcide::sliding_circuits::are_conjugate(
+                    b, c, conj, garcide::default_invariant_filter<B>(),
+                    decided_by)) {
+                ind_cout << EndLine() << "They are conjugates." << EndLine()
+                         << "A conjugating element is:" << EndLine() << conj
+                         << EndLine(1);
+            } else {
+                ind_cout << EndLine() << "They are not conjugates (told apart "
+                         << "by the " << decided_by << ").";
+            }
+        },
+        b, c);
 }
 
 #if BRAIDING_CLASS == 0